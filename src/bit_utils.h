@@ -1,8 +1,8 @@
 #ifndef BIT_UTILS_H
 #define BIT_UTILS_H
 
+#include <bit>     // For std::countr_zero and std::popcount
 #include <cstdint> // For fixed sized integers
-#include <vector>
 // Here we use inline because this permits the compiler copy inline the function
 // definitions whenever the functions name appears in the project.
 
@@ -32,27 +32,38 @@ inline int invertIndex(int index)
     return newRow * 8 + (index % 8);
 }
 
-inline std::vector<int> getBitIndices(uint64_t bitboard)
+// Range over the indices of the set bits of a bitboard, from the least significant one:
+// for (int square : getBitIndices(bitboard)). Bits are popped from a copy of the bitboard, so nothing is allocated.
+class BitIndices
 {
-    if (bitboard == 0)
+public:
+    class Iterator
     {
-        return {};
-    }
+    public:
+        explicit Iterator(uint64_t bitboard) : m_bitboard{bitboard} {}
+        int operator*() const { return std::countr_zero(m_bitboard); }
+        Iterator &operator++()
+        {
+            m_bitboard &= m_bitboard - 1;
+            return *this;
+        }
+        bool operator!=(const Iterator &other) const { return m_bitboard != other.m_bitboard; }
 
-    std::vector<int> indices;
-    indices.reserve(32); 
+    private:
+        uint64_t m_bitboard;
+    };
 
-    while (bitboard)
-    {
-        // Get the index of the least significant bit
-        int lsbi = getLeastSignificantBitIndex(bitboard);
-        indices.push_back(lsbi);
+    explicit BitIndices(uint64_t bitboard) : m_bitboard{bitboard} {}
+    Iterator begin() const { return Iterator(m_bitboard); }
+    Iterator end() const { return Iterator(0); }
 
-        // Remove the least significant bit from the bitboard
-        bitboard &= bitboard - 1;
-    }
+private:
+    uint64_t m_bitboard;
+};
 
-    return indices;
+inline BitIndices getBitIndices(uint64_t bitboard)
+{
+    return BitIndices(bitboard);
 }
 
 inline bool hasOneOne(uint64_t bitboard)
@@ -60,57 +71,9 @@ inline bool hasOneOne(uint64_t bitboard)
     return (bitboard & (bitboard - 1)) == 0;
 }
 
-inline std::vector<std::vector<int>> generateSubvectors(const std::vector<int> &vec) // Works
-// Returns all subvectors from a vector. Used in generate_subbits.
-{
-    std::vector<std::vector<int>> subvectors;
-    int n = vec.size();
-    unsigned int powSetSize = 1 << n; // There are 2^n subsets
-
-    for (unsigned int counter = 0; counter < powSetSize; ++counter)
-    {
-        std::vector<int> subvec;
-        for (int j = 0; j < n; ++j)
-        {
-            // Check if jth element is in the current subset
-            if (counter & (1 << j))
-            {
-                subvec.push_back(vec[j]);
-            }
-        }
-        subvectors.push_back(subvec);
-    }
-
-    return subvectors;
-}
-
-inline std::vector<uint64_t> generateSubbits(uint64_t bit) // Works
-// Returns the all the subbits of a given bit. Used in generate_blocker_configurations.
-{
-    std::vector<int> indeces{getBitIndices(bit)};                                 // Indeces of 1's in bit
-    std::vector<std::vector<int>> subvector_indeces{generateSubvectors(indeces)}; // Vector of subvectors containing all the indeces of the subbits
-    std::vector<uint64_t> subbits{};
-    for (std::vector<int> indeces : subvector_indeces)
-    {
-        uint64_t bit{};
-        for (int index : indeces)
-        {
-            bit |= (1ULL << index);
-        }
-        subbits.push_back(bit);
-    }
-    return subbits;
-}
-
-// Helper function to count the number of set bits in a 64-bit integer
+// Number of set bits in a 64-bit integer
 inline int countBits(uint64_t bitboard)
 {
-    int count = 0;
-    while (bitboard)
-    {
-        bitboard &= (bitboard - 1); // Clear the least significant bit set
-        count++;
-    }
-    return count;
+    return std::popcount(bitboard);
 }
 #endif // BIT_UTILS_H
\ No newline at end of file
@@ -62,6 +62,19 @@ template bool BitPosition::isLegal<ScoredMove>(const ScoredMove *move) const;
 template bool BitPosition::isCaptureLegal<Move>(const Move *move) const;
 template bool BitPosition::isCaptureLegal<ScoredMove>(const ScoredMove *move) const;
 
+template Move *BitPosition::pawnNonCapturesNonQueenProms<Move>(Move *&move_list) const;
+template ScoredMove *BitPosition::pawnNonCapturesNonQueenProms<ScoredMove>(ScoredMove *&move_list) const;
+template Move *BitPosition::knightNonCaptures<Move>(Move *&move_list) const;
+template ScoredMove *BitPosition::knightNonCaptures<ScoredMove>(ScoredMove *&move_list) const;
+template Move *BitPosition::bishopNonCaptures<Move>(Move *&move_list) const;
+template ScoredMove *BitPosition::bishopNonCaptures<ScoredMove>(ScoredMove *&move_list) const;
+template Move *BitPosition::rookNonCaptures<Move>(Move *&move_list) const;
+template ScoredMove *BitPosition::rookNonCaptures<ScoredMove>(ScoredMove *&move_list) const;
+template Move *BitPosition::queenNonCaptures<Move>(Move *&move_list) const;
+template ScoredMove *BitPosition::queenNonCaptures<ScoredMove>(ScoredMove *&move_list) const;
+template Move *BitPosition::kingNonCaptures<Move>(Move *&move_list) const;
+template ScoredMove *BitPosition::kingNonCaptures<ScoredMove>(ScoredMove *&move_list) const;
+
 Move castling_moves[2][2]{{Move(16772), Move(16516)}, {Move(20412), Move(20156)}}; // [[WKS, WQS], [BKS, BQS]]
 
 constexpr uint64_t NON_LEFT_BITBOARD = 0b1111111011111110111111101111111011111110111111101111111011111110;
@@ -131,7 +144,6 @@ void BitPosition::initializeZobristKey()
     state_info->zobristKey ^= zobrist_keys::castlingRightsZobristNumbers[state_info->castlingRights];
     // Psquare key
     state_info->zobristKey ^= zobrist_keys::passantSquaresZobristNumbers[state_info->pSquare];
-    m_zobrist_keys_array[127 - m_ply] = state_info->zobristKey;
 }
 void BitPosition::setIsCheckOnInitialization()
 // For when moving the king
@@ -515,13 +527,16 @@ bool BitPosition::newKingSquareIsSafe(int new_position) const
 }
 
 bool BitPosition::kingIsSafeAfterPassant(int removed_square_1, int removed_square_2) const // See if the king is in check or not (from kings position). For when moving the king.
+// The capturing pawn lands on the passant square, which can block a slider ray to our king
 {
+    uint64_t occupied{(m_all_pieces_bit & ~((1ULL << removed_square_1) | (1ULL << removed_square_2))) | (1ULL << state_info->pSquare)};
+
     // Black bishops and queens
-    if ((BmagicNOMASK(m_king_position[not m_turn], precomputed_moves::bishop_unfull_rays[m_king_position[not m_turn]] & (m_all_pieces_bit & ~((1ULL << removed_square_1) | (1ULL << removed_square_2)))) & (m_pieces[m_turn][2] | m_pieces[m_turn][4])) != 0)
+    if ((BmagicNOMASK(m_king_position[not m_turn], precomputed_moves::bishop_unfull_rays[m_king_position[not m_turn]] & occupied) & (m_pieces[m_turn][2] | m_pieces[m_turn][4])) != 0)
         return false;
 
     // Black rooks and queens
-    if ((RmagicNOMASK(m_king_position[not m_turn], precomputed_moves::rook_unfull_rays[m_king_position[not m_turn]] & (m_all_pieces_bit & ~((1ULL << removed_square_1) | (1ULL << removed_square_2)))) & (m_pieces[m_turn][3] | m_pieces[m_turn][4])) != 0)
+    if ((RmagicNOMASK(m_king_position[not m_turn], precomputed_moves::rook_unfull_rays[m_king_position[not m_turn]] & occupied) & (m_pieces[m_turn][3] | m_pieces[m_turn][4])) != 0)
         return false;
     return true;
 }
@@ -548,6 +563,18 @@ bool BitPosition::isDiscoverCheck(int origin_square, int destination_square) con
     return true;
 }
 
+bool BitPosition::givesCheck(Move move) const
+// Direct checks through the check bits of the moving piece (kings give none), discovered checks as in isDiscoverCheck
+{
+    int origin_square{move.getOriginSquare()};
+    int destination_square{move.getDestinationSquare()};
+    int piece{m_board[origin_square] % 6};
+    if (piece != 5 && (state_info->checkBits[piece] & (1ULL << destination_square)))
+        return true;
+
+    return ((1ULL << origin_square) & state_info->blockersForKing) != 0 && (precomputed_moves::OnLineBitboards[origin_square][destination_square] & m_pieces[m_turn][5]) == 0;
+}
+
 bool BitPosition::isQueenCheck(int destination_square)
 {
     if ((precomputed_moves::precomputedQueenMovesTableOneBlocker2[destination_square][m_king_position[m_turn]] & m_all_pieces_bit) == m_pieces[m_turn][5])
@@ -566,14 +593,13 @@ bool BitPosition::isPromotionCheck(int piece, int destination_square)
     return false;
 }
 // First move generations
-std::vector<Move> BitPosition::inCheckAllMoves()
+MoveList<MAX_MOVES> BitPosition::inCheckAllMoves()
 // For first move search, we have to initialize check info
 {
     setCheckInfoOnInitialization();
     setBlockersAndPinsInAB();
     setCheckBits();
-    std::vector<Move> moves;
-    moves.reserve(64);
+    MoveList<MAX_MOVES> moves;
     if (m_turn) // White's turn
     {
         if (m_num_checks == 1)
@@ -587,16 +613,16 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                     if (destination < 56) // Non promotions
                     {
                         if (isNormalMoveLegal(destination - 8, destination))
-                            moves.emplace_back(Move(destination - 8, destination));
+                            moves.push_back(Move(destination - 8, destination));
                     }
                     else // Promotions
                     {
                         if (isNormalMoveLegal(destination - 8, destination))
                         {
-                            moves.emplace_back(Move(destination - 8, destination, 0));
-                            moves.emplace_back(Move(destination - 8, destination, 1));
-                            moves.emplace_back(Move(destination - 8, destination, 2));
-                            moves.emplace_back(Move(destination - 8, destination, 3));
+                            moves.push_back(Move(destination - 8, destination, 0));
+                            moves.push_back(Move(destination - 8, destination, 1));
+                            moves.push_back(Move(destination - 8, destination, 2));
+                            moves.push_back(Move(destination - 8, destination, 3));
                         }
                     }
             }
@@ -604,15 +630,15 @@ std::vector<Move> BitPosition::inCheckAllMoves()
             for (int destination : getBitIndices(shift_up(single_pawn_moves_bit & THIRD_ROW_BITBOARD) & ~m_all_pieces_bit & m_check_rays))
             {
                 if (isNormalMoveLegal(destination - 16, destination))
-                    moves.emplace_back(Move(destination - 16, destination));
+                    moves.push_back(Move(destination - 16, destination));
             }
-            // Passant block
-            if (((state_info->pSquare) & m_check_rays) != 0)
+            // Passant block or capture
+            if ((state_info->pSquare) != 0)
             {
                 for (int origin : getBitIndices(precomputed_moves::pawn_attacks[m_turn][state_info->pSquare] & m_pieces[0][0]))
                     if (kingIsSafeAfterPassant(origin, (state_info->pSquare) - 8)) // Legal
                     {
-                        moves.emplace_back(Move(origin, (state_info->pSquare), 0));
+                        moves.push_back(Move(origin, (state_info->pSquare), 0));
                     }
             }
             // Pawn captures from checking position
@@ -622,16 +648,16 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                 {
                     if (isNormalMoveLegal(origin, m_check_square))
                     {
-                        moves.emplace_back(Move(origin, m_check_square, 0));
-                        moves.emplace_back(Move(origin, m_check_square, 1));
-                        moves.emplace_back(Move(origin, m_check_square, 2));
-                        moves.emplace_back(Move(origin, m_check_square, 3));
+                        moves.push_back(Move(origin, m_check_square, 0));
+                        moves.push_back(Move(origin, m_check_square, 1));
+                        moves.push_back(Move(origin, m_check_square, 2));
+                        moves.push_back(Move(origin, m_check_square, 3));
                     }
                 }
                 else // Non promotion
                 {
                     if (isNormalMoveLegal(origin, m_check_square))
-                        moves.emplace_back(Move(origin, m_check_square));
+                        moves.push_back(Move(origin, m_check_square));
                 }
             }
             // Knight Blocks and Captures
@@ -640,7 +666,7 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                 for (int destination : getBitIndices(precomputed_moves::knight_moves[origin] & (m_check_rays | 1ULL << m_check_square)))
                 {
                     if (isNormalMoveLegal(origin, m_check_square))
-                        moves.emplace_back(Move(origin, destination));
+                        moves.push_back(Move(origin, destination));
                 }
             }
             // Bishop blocks and Captures
@@ -649,7 +675,7 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                 for (int destination : getBitIndices(BmagicNOMASK(origin, precomputed_moves::bishop_unfull_rays[origin] & m_all_pieces_bit) & ~m_pieces_bit[not m_turn] & (m_check_rays | 1ULL << m_check_square)))
                 {
                     if (isNormalMoveLegal(origin, destination))
-                        moves.emplace_back(Move(origin, destination));
+                        moves.push_back(Move(origin, destination));
                 }
             }
             // Rook blocks and Captures
@@ -658,7 +684,7 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                 for (int destination : getBitIndices(RmagicNOMASK(origin, precomputed_moves::rook_unfull_rays[origin] & m_all_pieces_bit) & ~m_pieces_bit[not m_turn] & (m_check_rays | 1ULL << m_check_square)))
                 {
                     if (isNormalMoveLegal(origin, m_check_square))
-                        moves.emplace_back(Move(origin, destination));
+                        moves.push_back(Move(origin, destination));
                 }
             }
             // Queen blocks and captures
@@ -667,7 +693,7 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                 for (int destination : getBitIndices((BmagicNOMASK(origin, precomputed_moves::bishop_unfull_rays[origin] & m_all_pieces_bit) | RmagicNOMASK(origin, precomputed_moves::rook_unfull_rays[origin] & m_all_pieces_bit)) & ~m_pieces_bit[not m_turn] & (m_check_rays | 1ULL << m_check_square)))
                 {
                     if (isNormalMoveLegal(origin, m_check_square))
-                        moves.emplace_back(Move(origin, destination));
+                        moves.push_back(Move(origin, destination));
                 }
             }
         }
@@ -675,7 +701,7 @@ std::vector<Move> BitPosition::inCheckAllMoves()
         for (int destination : getBitIndices(precomputed_moves::king_moves[m_king_position[not m_turn]] & ~m_pieces_bit[not m_turn]))
         {
             if (newKingSquareIsSafe(destination))
-                moves.emplace_back(Move(m_king_position[not m_turn], destination));
+                moves.push_back(Move(m_king_position[not m_turn], destination));
         }
     }
     else // Blacks turn
@@ -691,16 +717,16 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                     if (destination > 7) // Non promotions
                     {
                         if (isNormalMoveLegal(destination + 8, destination))
-                            moves.emplace_back(Move(destination + 8, destination));
+                            moves.push_back(Move(destination + 8, destination));
                     }
                     else // Promotions
                     {
                         if (isNormalMoveLegal(destination + 8, destination))
                         {
-                            moves.emplace_back(Move(destination + 8, destination, 0));
-                            moves.emplace_back(Move(destination + 8, destination, 1));
-                            moves.emplace_back(Move(destination + 8, destination, 2));
-                            moves.emplace_back(Move(destination + 8, destination, 3));
+                            moves.push_back(Move(destination + 8, destination, 0));
+                            moves.push_back(Move(destination + 8, destination, 1));
+                            moves.push_back(Move(destination + 8, destination, 2));
+                            moves.push_back(Move(destination + 8, destination, 3));
                         }
                     }
             }
@@ -708,15 +734,15 @@ std::vector<Move> BitPosition::inCheckAllMoves()
             for (int destination : getBitIndices(shift_down(single_pawn_moves_bit & SIXTH_ROW_BITBOARD) & ~m_all_pieces_bit & m_check_rays))
             {
                 if (isNormalMoveLegal(destination + 16, destination))
-                    moves.emplace_back(Move(destination + 16, destination));
+                    moves.push_back(Move(destination + 16, destination));
             }
-            // Passant block
-            if (((state_info->pSquare) & m_check_rays) != 0)
+            // Passant block or capture
+            if ((state_info->pSquare) != 0)
             {
                 for (int origin : getBitIndices(precomputed_moves::pawn_attacks[m_turn][state_info->pSquare] & m_pieces[1][0]))
                     if (kingIsSafeAfterPassant(origin, (state_info->pSquare) + 8)) // Legal
                     {
-                        moves.emplace_back(Move(origin, (state_info->pSquare), 0));
+                        moves.push_back(Move(origin, (state_info->pSquare), 0));
                     }
             }
             // Pawn captures from checking position
@@ -726,16 +752,16 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                         {
                             if (isNormalMoveLegal(origin, m_check_square))
                             {
-                                moves.emplace_back(Move(origin, m_check_square, 0));
-                                moves.emplace_back(Move(origin, m_check_square, 1));
-                                moves.emplace_back(Move(origin, m_check_square, 2));
-                                moves.emplace_back(Move(origin, m_check_square, 3));
+                                moves.push_back(Move(origin, m_check_square, 0));
+                                moves.push_back(Move(origin, m_check_square, 1));
+                                moves.push_back(Move(origin, m_check_square, 2));
+                                moves.push_back(Move(origin, m_check_square, 3));
                             }
                         }
                         else // Non promotion
                         {
                             if (isNormalMoveLegal(origin, m_check_square))
-                                moves.emplace_back(Move(origin, m_check_square));
+                                moves.push_back(Move(origin, m_check_square));
                         }
             }
             // Knight blocks and Captures
@@ -744,7 +770,7 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                 for (int destination : getBitIndices(precomputed_moves::knight_moves[origin] & (m_check_rays | 1ULL << m_check_square)))
                 {
                     if (isNormalMoveLegal(origin, destination))
-                        moves.emplace_back(Move(origin, destination));
+                        moves.push_back(Move(origin, destination));
                 }
             }
             // Bishop blocks and Captures
@@ -753,7 +779,7 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                 for (int destination : getBitIndices(BmagicNOMASK(origin, precomputed_moves::bishop_unfull_rays[origin] & m_all_pieces_bit) & ~m_pieces_bit[not m_turn] & (m_check_rays | 1ULL << m_check_square)))
                 {
                     if (isNormalMoveLegal(origin, destination))
-                        moves.emplace_back(Move(origin, destination));
+                        moves.push_back(Move(origin, destination));
                 }
             }
             // Rook blocks and Captures
@@ -762,7 +788,7 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                 for (int destination : getBitIndices(RmagicNOMASK(origin, precomputed_moves::rook_unfull_rays[origin] & m_all_pieces_bit) & ~m_pieces_bit[not m_turn] & (m_check_rays | 1ULL << m_check_square)))
                 {
                     if (isNormalMoveLegal(origin, destination))
-                        moves.emplace_back(Move(origin, destination));
+                        moves.push_back(Move(origin, destination));
                 }
             }
             // Queen blocks and captures
@@ -771,7 +797,7 @@ std::vector<Move> BitPosition::inCheckAllMoves()
                 for (int destination : getBitIndices((BmagicNOMASK(origin, precomputed_moves::bishop_unfull_rays[origin] & m_all_pieces_bit) | RmagicNOMASK(origin, precomputed_moves::rook_unfull_rays[origin] & m_all_pieces_bit)) & ~m_pieces_bit[not m_turn] & (m_check_rays | 1ULL << m_check_square)))
                 {
                     if (isNormalMoveLegal(origin, destination))
-                        moves.emplace_back(Move(origin, destination));
+                        moves.push_back(Move(origin, destination));
                 }
             }
         }
@@ -779,18 +805,17 @@ std::vector<Move> BitPosition::inCheckAllMoves()
         for (int destination : getBitIndices(precomputed_moves::king_moves[m_king_position[not m_turn]] & ~m_pieces_bit[not m_turn]))
         {
             if (newKingSquareIsSafe(destination))
-                moves.emplace_back(Move(m_king_position[not m_turn], destination));
+                moves.push_back(Move(m_king_position[not m_turn], destination));
         }
     }
     return moves;
 }
-std::vector<Move> BitPosition::allMoves()
+MoveList<MAX_MOVES> BitPosition::allMoves()
 // For first move search
 {
     setBlockersAndPinsInAB();
     setCheckBits();
-    std::vector<Move> moves;
-    moves.reserve(128);
+    MoveList<MAX_MOVES> moves;
     if (m_turn) // White's turn
     {
         // Knights
@@ -798,7 +823,7 @@ std::vector<Move> BitPosition::allMoves()
         {
             for (int destination : getBitIndices(precomputed_moves::knight_moves[origin] & ~m_pieces_bit[not m_turn]))
             {
-                moves.emplace_back(Move(origin, destination));
+                moves.push_back(Move(origin, destination));
             }
         }
         // Bishops
@@ -807,7 +832,7 @@ std::vector<Move> BitPosition::allMoves()
             for (int destination : getBitIndices(BmagicNOMASK(origin, precomputed_moves::bishop_unfull_rays[origin] & m_all_pieces_bit) & ~m_pieces_bit[not m_turn]))
             {
                 if (isNormalMoveLegal(origin, destination))
-                    moves.emplace_back(Move(origin, destination));
+                    moves.push_back(Move(origin, destination));
             }
         }
         // Rooks
@@ -816,7 +841,7 @@ std::vector<Move> BitPosition::allMoves()
             for (int destination : getBitIndices(RmagicNOMASK(origin, precomputed_moves::rook_unfull_rays[origin] & m_all_pieces_bit) & ~m_pieces_bit[not m_turn]))
             {
                 if (isNormalMoveLegal(origin, destination))
-                    moves.emplace_back(Move(origin, destination));
+                    moves.push_back(Move(origin, destination));
             }
         }
         // Queens
@@ -825,7 +850,7 @@ std::vector<Move> BitPosition::allMoves()
             for (int destination : getBitIndices((BmagicNOMASK(origin, precomputed_moves::bishop_unfull_rays[origin] & m_all_pieces_bit) | RmagicNOMASK(origin, precomputed_moves::rook_unfull_rays[origin] & m_all_pieces_bit)) & ~m_pieces_bit[not m_turn]))
             {
                 if (isNormalMoveLegal(origin, destination))
-                    moves.emplace_back(Move(origin, destination));
+                    moves.push_back(Move(origin, destination));
             }
         }
         // Single moves
@@ -836,14 +861,14 @@ std::vector<Move> BitPosition::allMoves()
             {
                 if (destination < 56) // Non promotions
                 {
-                    moves.emplace_back(Move(destination - 8, destination));
+                    moves.push_back(Move(destination - 8, destination));
                 }
                 else // Promotions
                 {
-                    moves.emplace_back(Move(destination - 8, destination, 0));
-                    moves.emplace_back(Move(destination - 8, destination, 1));
-                    moves.emplace_back(Move(destination - 8, destination, 2));
-                    moves.emplace_back(Move(destination - 8, destination, 3));
+                    moves.push_back(Move(destination - 8, destination, 0));
+                    moves.push_back(Move(destination - 8, destination, 1));
+                    moves.push_back(Move(destination - 8, destination, 2));
+                    moves.push_back(Move(destination - 8, destination, 3));
                 }
             }
         }
@@ -851,7 +876,7 @@ std::vector<Move> BitPosition::allMoves()
         for (int destination : getBitIndices(shift_up(single_pawn_moves_bit & THIRD_ROW_BITBOARD) & ~m_all_pieces_bit))
         {
             if (isNormalMoveLegal(destination - 16, destination))
-                moves.emplace_back(Move(destination - 16, destination));
+                moves.push_back(Move(destination - 16, destination));
         }
         // Right shift captures
         for (int destination : getBitIndices(shift_up_right(m_pieces[0][0] & NON_RIGHT_BITBOARD & ~(state_info->straightPinnedPieces) ) & m_pieces_bit[m_turn]))
@@ -860,14 +885,14 @@ std::vector<Move> BitPosition::allMoves()
             {
                 if (destination < 56) // Non promotions
                 {
-                    moves.emplace_back(Move(destination - 9, destination));
+                    moves.push_back(Move(destination - 9, destination));
                 }
                 else // Promotions
                 {
-                    moves.emplace_back(Move(destination - 9, destination, 0));
-                    moves.emplace_back(Move(destination - 9, destination, 1));
-                    moves.emplace_back(Move(destination - 9, destination, 2));
-                    moves.emplace_back(Move(destination - 9, destination, 3));
+                    moves.push_back(Move(destination - 9, destination, 0));
+                    moves.push_back(Move(destination - 9, destination, 1));
+                    moves.push_back(Move(destination - 9, destination, 2));
+                    moves.push_back(Move(destination - 9, destination, 3));
                 }
             }
         }
@@ -878,14 +903,14 @@ std::vector<Move> BitPosition::allMoves()
             {
                 if (destination < 56) // Non promotions
                 {
-                    moves.emplace_back(Move(destination - 7, destination));
+                    moves.push_back(Move(destination - 7, destination));
                 }
                 else // Promotions
                 {
-                    moves.emplace_back(Move(destination - 7, destination, 0));
-                    moves.emplace_back(Move(destination - 7, destination, 1));
-                    moves.emplace_back(Move(destination - 7, destination, 2));
-                    moves.emplace_back(Move(destination - 7, destination, 3));
+                    moves.push_back(Move(destination - 7, destination, 0));
+                    moves.push_back(Move(destination - 7, destination, 1));
+                    moves.push_back(Move(destination - 7, destination, 2));
+                    moves.push_back(Move(destination - 7, destination, 3));
                 }
             }
         }
@@ -895,7 +920,7 @@ std::vector<Move> BitPosition::allMoves()
             for (int origin : getBitIndices(precomputed_moves::pawn_attacks[m_turn][state_info->pSquare] & m_pieces[0][0]))
                 if (kingIsSafeAfterPassant(origin, (state_info->pSquare) - 8)) // Legal
                 {
-                    moves.emplace_back(Move(origin, state_info->pSquare, 0));
+                    moves.push_back(Move(origin, state_info->pSquare, 0));
                 }
         }
 
@@ -903,14 +928,14 @@ std::vector<Move> BitPosition::allMoves()
         for (int destination : getBitIndices(precomputed_moves::king_moves[m_king_position[not m_turn]] & ~m_pieces_bit[not m_turn]))
         {
             if (newKingSquareIsSafe(destination))
-                moves.emplace_back(Move(m_king_position[not m_turn], destination));
+                moves.push_back(Move(m_king_position[not m_turn], destination));
         }
         // Kingside castling
         if ((state_info->castlingRights & WHITE_KS) && (m_all_pieces_bit & 96) == 0 && newKingSquareIsSafe(5) && newKingSquareIsSafe(6))
-            moves.emplace_back(castling_moves[0][0]);
+            moves.push_back(castling_moves[0][0]);
         // Queenside castling
         if ((state_info->castlingRights & WHITE_QS) && (m_all_pieces_bit & 14) == 0 && newKingSquareIsSafe(2) && newKingSquareIsSafe(3))
-            moves.emplace_back(castling_moves[0][1]);
+            moves.push_back(castling_moves[0][1]);
     }
     else // Black's turn
     {
@@ -919,7 +944,7 @@ std::vector<Move> BitPosition::allMoves()
         {
             for (int destination : getBitIndices(precomputed_moves::knight_moves[origin] & ~m_pieces_bit[not m_turn]))
             {
-                moves.emplace_back(Move(origin, destination));
+                moves.push_back(Move(origin, destination));
             }
         }
         // Bishops
@@ -928,7 +953,7 @@ std::vector<Move> BitPosition::allMoves()
             for (int destination : getBitIndices(BmagicNOMASK(origin, precomputed_moves::bishop_unfull_rays[origin] & m_all_pieces_bit) & ~m_pieces_bit[not m_turn]))
             {
                 if (isNormalMoveLegal(origin, destination))
-                    moves.emplace_back(Move(origin, destination));
+                    moves.push_back(Move(origin, destination));
             }
         }
         // Rooks
@@ -937,7 +962,7 @@ std::vector<Move> BitPosition::allMoves()
             for (int destination : getBitIndices(RmagicNOMASK(origin, precomputed_moves::rook_unfull_rays[origin] & m_all_pieces_bit) & ~m_pieces_bit[not m_turn]))
             {
                 if (isNormalMoveLegal(origin, destination))
-                    moves.emplace_back(Move(origin, destination));
+                    moves.push_back(Move(origin, destination));
             }
         }
         // Queens
@@ -946,7 +971,7 @@ std::vector<Move> BitPosition::allMoves()
             for (int destination : getBitIndices((BmagicNOMASK(origin, precomputed_moves::bishop_unfull_rays[origin] & m_all_pieces_bit) | RmagicNOMASK(origin, precomputed_moves::rook_unfull_rays[origin] & m_all_pieces_bit)) & ~m_pieces_bit[not m_turn]))
             {
                 if (isNormalMoveLegal(origin, destination))
-                    moves.emplace_back(Move(origin, destination));
+                    moves.push_back(Move(origin, destination));
             }
         }
         // Single moves
@@ -957,14 +982,14 @@ std::vector<Move> BitPosition::allMoves()
             {
                 if (destination > 7) // Non promotions
                 {
-                        moves.emplace_back(Move(destination + 8, destination));
+                        moves.push_back(Move(destination + 8, destination));
                 }
                 else // Promotions
                 {
-                        moves.emplace_back(Move(destination + 8, destination, 0));
-                        moves.emplace_back(Move(destination + 8, destination, 1));
-                        moves.emplace_back(Move(destination + 8, destination, 2));
-                        moves.emplace_back(Move(destination + 8, destination, 3));
+                        moves.push_back(Move(destination + 8, destination, 0));
+                        moves.push_back(Move(destination + 8, destination, 1));
+                        moves.push_back(Move(destination + 8, destination, 2));
+                        moves.push_back(Move(destination + 8, destination, 3));
                 }
             }
         }
@@ -972,7 +997,7 @@ std::vector<Move> BitPosition::allMoves()
         for (int destination : getBitIndices(shift_down(single_pawn_moves_bit & SIXTH_ROW_BITBOARD) & ~m_all_pieces_bit))
         {
             if (isNormalMoveLegal(destination + 16, destination))
-                moves.emplace_back(Move(destination + 16, destination));
+                moves.push_back(Move(destination + 16, destination));
         }
         // Right shift captures
         for (int destination : getBitIndices(shift_down_right(m_pieces[1][0] & NON_RIGHT_BITBOARD & ~(state_info->straightPinnedPieces) ) & m_pieces_bit[m_turn]))
@@ -981,14 +1006,14 @@ std::vector<Move> BitPosition::allMoves()
             {
                 if (destination > 7) // Non promotions
                 {
-                        moves.emplace_back(Move(destination + 7, destination));
+                        moves.push_back(Move(destination + 7, destination));
                 }
                 else // Promotions
                 {
-                        moves.emplace_back(Move(destination + 7, destination, 0));
-                        moves.emplace_back(Move(destination + 7, destination, 1));
-                        moves.emplace_back(Move(destination + 7, destination, 2));
-                        moves.emplace_back(Move(destination + 7, destination, 3));
+                        moves.push_back(Move(destination + 7, destination, 0));
+                        moves.push_back(Move(destination + 7, destination, 1));
+                        moves.push_back(Move(destination + 7, destination, 2));
+                        moves.push_back(Move(destination + 7, destination, 3));
                 }
             }
         }
@@ -999,14 +1024,14 @@ std::vector<Move> BitPosition::allMoves()
             {
                 if (destination > 7) // Non promotions
                 {
-                        moves.emplace_back(Move(destination + 9, destination));
+                        moves.push_back(Move(destination + 9, destination));
                 }
                 else // Promotions
                 {
-                        moves.emplace_back(Move(destination + 9, destination, 0));
-                        moves.emplace_back(Move(destination + 9, destination, 1));
-                        moves.emplace_back(Move(destination + 9, destination, 2));
-                        moves.emplace_back(Move(destination + 9, destination, 3));
+                        moves.push_back(Move(destination + 9, destination, 0));
+                        moves.push_back(Move(destination + 9, destination, 1));
+                        moves.push_back(Move(destination + 9, destination, 2));
+                        moves.push_back(Move(destination + 9, destination, 3));
                 }
             }
         }
@@ -1016,30 +1041,30 @@ std::vector<Move> BitPosition::allMoves()
             for (int origin : getBitIndices(precomputed_moves::pawn_attacks[m_turn][state_info->pSquare] & m_pieces[1][0]))
                 if (kingIsSafeAfterPassant(origin, (state_info->pSquare) + 8))
                 {
-                        moves.emplace_back(Move(origin, (state_info->pSquare), 0));
+                        moves.push_back(Move(origin, (state_info->pSquare), 0));
                 }
         }
         // King moves
         for (int destination : getBitIndices(precomputed_moves::king_moves[m_king_position[not m_turn]] & ~m_pieces_bit[not m_turn]))
         {
             if (newKingSquareIsSafe(destination))
-                moves.emplace_back(Move(m_king_position[not m_turn], destination));
+                moves.push_back(Move(m_king_position[not m_turn], destination));
         }
         // Kingside castling
         if ((state_info->castlingRights & BLACK_KS) && (m_all_pieces_bit & 6917529027641081856) == 0 && newKingSquareIsSafe(61) && newKingSquareIsSafe(62))
-            moves.emplace_back(castling_moves[1][0]);
+            moves.push_back(castling_moves[1][0]);
         // Queenside castling
         if ((state_info->castlingRights & BLACK_QS) && (m_all_pieces_bit & 1008806316530991104) == 0 && newKingSquareIsSafe(58) && newKingSquareIsSafe(59))
-            moves.emplace_back(castling_moves[1][1]);
+            moves.push_back(castling_moves[1][1]);
     }
     return moves;
 }
 
-std::vector<Move> BitPosition::orderAllMovesOnFirstIterationFirstTime(std::vector<Move> &moves, Move ttMove) const
+void BitPosition::orderAllMovesOnFirstIterationFirstTime(MoveList<MAX_MOVES> &moves, Move ttMove) const
 // This is the same as orderAllMoves but we have a ttMove which is the best move found at a better depth but incomplete search due to cutoff.
 {
-    std::vector<std::pair<Move, int>> moves_and_scores;
-    moves_and_scores.reserve(moves.size()); // Reserve space to avoid reallocations
+    std::pair<Move, int> moves_and_scores[MAX_MOVES];
+    int moves_count{0};
 
     if (m_turn) // Whites turn
     {
@@ -1048,7 +1073,7 @@ std::vector<Move> BitPosition::orderAllMovesOnFirstIterationFirstTime(std::vecto
             // If move was found on ttable at a better depth to be the best move (although the search might have been cutoff, so we can't blindly use this move)
             if (move.getData() == ttMove.getData() && move.getData() != 0)
             {
-                moves_and_scores.emplace_back(move, 62);
+                moves_and_scores[moves_count++] = {move, 62};
             }
             else
             {
@@ -1086,7 +1111,7 @@ std::vector<Move> BitPosition::orderAllMovesOnFirstIterationFirstTime(std::vecto
                     else if ((destination_bit & m_pieces[1][4]) != 0)
                         score += 50;
                 }
-                moves_and_scores.emplace_back(move, score);
+                moves_and_scores[moves_count++] = {move, score};
             }
         }
     }
@@ -1096,7 +1121,7 @@ std::vector<Move> BitPosition::orderAllMovesOnFirstIterationFirstTime(std::vecto
         {
             if (move.getData() == ttMove.getData() && move.getData() != 0)
             {
-                moves_and_scores.emplace_back(move, 62);
+                moves_and_scores[moves_count++] = {move, 62};
             }
             else
             {
@@ -1133,60 +1158,53 @@ std::vector<Move> BitPosition::orderAllMovesOnFirstIterationFirstTime(std::vecto
                     else if ((destination_bit & m_pieces[0][4]) != 0)
                         score += 50;
                 }
-                moves_and_scores.emplace_back(move, score);
+                moves_and_scores[moves_count++] = {move, score};
             }
         }
     }
     // Order moves
-    // Sort the pair vector by scores, highest first
-    std::sort(moves_and_scores.begin(), moves_and_scores.end(),
+    // Sort the pair array by scores, highest first
+    std::sort(moves_and_scores, moves_and_scores + moves_count,
               [](const std::pair<Move, int> &a, const std::pair<Move, int> &b)
               {
                   return a.second > b.second; // Sort by score in descending order
               });
 
-    // Clear the original moves vector and repopulate it with sorted moves
-    moves.clear();                          // Clear the input vector if modifying it directly
-    moves.reserve(moves_and_scores.size()); // Reserve space to avoid reallocations
-
-    // Unpack the sorted moves into the vector
-    for (const auto &move_score : moves_and_scores)
-    {
-        moves.push_back(move_score.first); // Note: first is the Move
-    }
-
-    return moves; // Return the sorted moves
+    // Unpack the sorted moves into the list
+    for (int i = 0; i < moves_count; ++i)
+        moves[i] = moves_and_scores[i].first;
 }
-std::pair<std::vector<Move>, std::vector<int16_t>> BitPosition::orderAllMovesOnFirstIteration(std::vector<Move> &moves, std::vector<int16_t> &scores) const
+void BitPosition::orderAllMovesOnFirstIteration(MoveList<MAX_MOVES> &moves, FixedList<int16_t, MAX_MOVES> &scores) const
+// Sorts moves and their scores together, by score in descending order
 {
-    // Create a vector of indices
-    std::vector<int> indices(moves.size());
-    for (int i = 0; i < indices.size(); ++i)
+    // Create an array of indices
+    int indices[MAX_MOVES];
+    for (int i = 0; i < moves.size(); ++i)
     {
         indices[i] = i;
     }
 
     // Sort the indices based on the scores in descending order
-    std::sort(indices.begin(), indices.end(), [&scores](int a, int b)
+    std::sort(indices, indices + moves.size(), [&scores](int a, int b)
               { return scores[a] > scores[b]; });
 
-    // Create a new vector for the sorted moves
-    std::vector<Move> sortedMoves;
-    std::vector<int16_t> sortedScores;
-    sortedMoves.reserve(moves.size());
-    sortedScores.reserve(moves.size());
-    for (int index : indices)
+    // Copies of the unsorted lists, to write the sorted ones in place
+    MoveList<MAX_MOVES> unsorted_moves{moves};
+    FixedList<int16_t, MAX_MOVES> unsorted_scores{scores};
+    for (int i = 0; i < moves.size(); ++i)
     {
-        sortedMoves.push_back(moves[index]);
-        sortedScores.push_back(scores[index]);
+        moves[i] = unsorted_moves[indices[i]];
+        scores[i] = unsorted_scores[indices[i]];
     }
-
-    return std::pair<std::vector<Move>, std::vector<int16_t>>{sortedMoves, sortedScores}; // Return the sorted moves
 }
 
 // Refutation move generations (for Quiesence)
 Move BitPosition::getBestRefutation()
 {
+    // No refutations after a null move
+    if (state_info->lastDestinationBit == 0)
+        return Move(0);
+
     if (m_turn) // White Pawns
     {
         // Right shift captures
@@ -2504,29 +2522,6 @@ ScoredMove *BitPosition::setGoodCapturesOrdered(ScoredMove *&move_list_end)
     return move_list_end;
 }
 
-// Moving pieces functions
-void BitPosition::resetPlyInfo()
-// This member function is used when either opponent or engine makes a capture.
-// To make the ply info smaller. For a faster 3 fold repetition check.
-// It isn't used when making a move in search!
-{
-    m_ply = 0;
-    m_zobrist_keys_array.fill(0);
-    m_zobrist_keys_array[127] = state_info->zobristKey;
-}
-
-bool BitPosition::moveIsReseter(Move move)
-// Return if move is a capture
-{
-    uint64_t destination_bit{1ULL << move.getDestinationSquare()};
-    uint64_t origin_bit{1ULL << move.getDestinationSquare()};
-    if ((m_pieces_bit[m_turn] & destination_bit)) // Capture
-        return true;
-    if ((m_pieces[not m_turn][0] & origin_bit) || (state_info->pSquare) == destination_bit) // Passant Capture
-        return true;
-    return false;
-}
-
 bool BitPosition::isDraw() const
 {
     // 50 move rule
@@ -2534,17 +2529,19 @@ bool BitPosition::isDraw() const
         return true;
 
     // Threefold repetitions
-    if (state_info->reversibleMovesMade < 8)
+    // We must only check positions spaced by 2 moves since repetitions are from player's perspective,
+    // and no position before the last irreversible move or null move can be repeated
+    int end{std::min(state_info->reversibleMovesMade, state_info->pliesFromNull)};
+    if (end < 8)
         return false;
 
-    // Find how many keys are equal to this zobrist key
-    // We are currently at m_ply,
-    // Each time we make a move we do m_zobrist_keys_array[127 - m_ply] = zobrist_key
-    // We must only check positions spaced by 2 moves since repetitions are from player's perspective
+    // Find how many keys are equal to this zobrist key, walking back through the previous states
+    const StateInfo *previous_state{state_info->previous->previous};
     int count = 0;
-    for (int i = m_ply - 4; i >= 0; i -= 2)
+    for (int i = 4; i <= end; i += 2)
     {
-        if (m_zobrist_keys_array[127 - i] == state_info->zobristKey)
+        previous_state = previous_state->previous->previous;
+        if (previous_state->zobristKey == state_info->zobristKey)
         {
             if (++count == 2)
                 return true;
@@ -2553,6 +2550,133 @@ bool BitPosition::isDraw() const
     return false;
 }
 
+bool BitPosition::hasUpcomingRepetition(int ply_from_root) const
+// Returns if the side to move has a reversible move back to a position of the game or search (so it can at least draw).
+// Positions an odd number of plies back differ from a position after one of our moves by a single piece move,
+// which we find looking up the difference of zobrist keys in the cuckoo tables.
+// Inside the search one repetition is taken as a draw, as in isDraw a position before the root must already be repeated.
+{
+    int end{std::min(state_info->reversibleMovesMade, state_info->pliesFromNull)};
+    if (end < 3)
+        return false;
+
+    const StateInfo *previous_state{state_info->previous};
+    for (int i = 3; i <= end; i += 2)
+    {
+        previous_state = previous_state->previous->previous;
+        uint64_t move_key{state_info->zobristKey ^ previous_state->zobristKey};
+        int index{zobrist_keys::cuckooHash1(move_key)};
+        if (zobrist_keys::cuckooKeys[index] != move_key)
+        {
+            index = zobrist_keys::cuckooHash2(move_key);
+            if (zobrist_keys::cuckooKeys[index] != move_key)
+                continue;
+        }
+
+        // The path of the move must be empty
+        Move move{zobrist_keys::cuckooMoves[index]};
+        int square_1{move.getOriginSquare()};
+        int square_2{move.getDestinationSquare()};
+        if (precomputed_moves::precomputedQueenMovesTableOneBlocker[square_1][square_2] & m_all_pieces_bit)
+            continue;
+
+        if (ply_from_root > i)
+            return true;
+
+        // Before the root the move has to be ours, not the opponent's move that led to this position
+        int moved_square{m_board[square_1] == NO_PIECE ? square_2 : square_1};
+        if ((m_board[moved_square] < 6) != m_turn)
+            continue;
+        const StateInfo *earlier_state{previous_state};
+        for (int j = i + 2; j <= end; j += 2)
+        {
+            earlier_state = earlier_state->previous->previous;
+            if (earlier_state->zobristKey == previous_state->zobristKey)
+                return true;
+        }
+    }
+    return false;
+}
+
+// Static exchange evaluation
+// Piece values in centipawns, only used to resolve exchanges on one square
+constexpr int SEE_VALUES[6]{100, 300, 300, 500, 900, 20000};
+
+uint64_t BitPosition::attackersTo(int square, uint64_t occupied) const
+// Pieces of both colours attacking square, with sliders seeing through the removed pieces of occupied
+{
+    return (precomputed_moves::pawn_attacks[1][square] & m_pieces[0][0]) |
+           (precomputed_moves::pawn_attacks[0][square] & m_pieces[1][0]) |
+           (precomputed_moves::knight_moves[square] & (m_pieces[0][1] | m_pieces[1][1])) |
+           (BmagicNOMASK(square, precomputed_moves::bishop_unfull_rays[square] & occupied) & (m_pieces[0][2] | m_pieces[1][2] | m_pieces[0][4] | m_pieces[1][4])) |
+           (RmagicNOMASK(square, precomputed_moves::rook_unfull_rays[square] & occupied) & (m_pieces[0][3] | m_pieces[1][3] | m_pieces[0][4] | m_pieces[1][4])) |
+           (precomputed_moves::king_moves[square] & (m_pieces[0][5] | m_pieces[1][5]));
+}
+
+bool BitPosition::seeGe(Move move, int threshold) const
+// Returns if the exchange sequence started by move on its destination square wins at least threshold.
+// Both sides recapture with their least valuable attacker and may stop when it doesn't pay off.
+// Pins are ignored, and special moves (promotions, passant and castling) are taken as even exchanges.
+{
+    if (move.getData() & 0b0100000000000000)
+        return 0 >= threshold;
+
+    int origin{move.getOriginSquare()};
+    int destination{move.getDestinationSquare()};
+    int moved_piece{m_turn ? whitePieceOn(origin) : blackPieceOn(origin)};
+    int captured_piece{m_turn ? blackPieceOn(destination) : whitePieceOn(destination)};
+
+    // Value of what we capture, minus the threshold
+    int swap{(captured_piece == 7 ? 0 : SEE_VALUES[captured_piece]) - threshold};
+    if (swap < 0)
+        return false;
+
+    // Even losing the moving piece we keep the threshold
+    swap = SEE_VALUES[moved_piece] - swap;
+    if (swap <= 0)
+        return true;
+
+    uint64_t occupied{m_all_pieces_bit ^ (1ULL << origin) ^ (1ULL << destination)};
+    uint64_t attackers{attackersTo(destination, occupied)};
+    uint64_t diagonal_sliders{m_pieces[0][2] | m_pieces[1][2] | m_pieces[0][4] | m_pieces[1][4]};
+    uint64_t straight_sliders{m_pieces[0][3] | m_pieces[1][3] | m_pieces[0][4] | m_pieces[1][4]};
+    int side{m_turn ? 0 : 1}; // Side that made the last capture
+    int result{1};
+
+    while (true)
+    {
+        side ^= 1;
+        attackers &= occupied;
+        uint64_t side_attackers{attackers & m_pieces_bit[side]};
+        if (side_attackers == 0)
+            break;
+
+        result ^= 1;
+
+        // Least valuable attacker recaptures
+        int piece{0};
+        while (piece < 5 && (side_attackers & m_pieces[side][piece]) == 0)
+            piece++;
+
+        // A king can only recapture if the square is no longer defended
+        if (piece == 5)
+            return (attackers & ~m_pieces_bit[side]) ? result ^ 1 : result;
+
+        swap = SEE_VALUES[piece] - swap;
+        if (swap < result)
+            break;
+
+        occupied ^= (side_attackers & m_pieces[side][piece]) & -(side_attackers & m_pieces[side][piece]);
+
+        // Sliders behind the recapturing piece join the exchange
+        if (piece == 0 || piece == 2 || piece == 4)
+            attackers |= BmagicNOMASK(destination, precomputed_moves::bishop_unfull_rays[destination] & occupied) & diagonal_sliders;
+        if (piece == 3 || piece == 4)
+            attackers |= RmagicNOMASK(destination, precomputed_moves::rook_unfull_rays[destination] & occupied) & straight_sliders;
+    }
+    return result;
+}
+
 template <typename T>
 void BitPosition::makeMove(T move, StateInfo &new_state_info)
 // Move piece and switch white and black roles, without rotating the board.
@@ -2560,9 +2684,9 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
 {
     // Save irreversible aspects of position and create a new state
     // Irreversible aspects include: castlingRights, fiftyMoveCount, zobristKey and pSquare
-    std::memcpy(&new_state_info, state_info, offsetof(StateInfo, straightPinnedPieces));
+    std::memcpy(&new_state_info, state_info, offsetof(StateInfo, lastDestinationBit));
+    copyAccumulators(new_state_info, *state_info);
     new_state_info.previous = state_info;
-    state_info->next = &new_state_info;
     state_info = &new_state_info;
 
     // std::string fen_before{toFenString()}; // Debugging purpose
@@ -2575,6 +2699,7 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
     int captured_piece;
     m_promoted_piece = 7; // Representing no promotion (Used for updating check info)
     state_info->reversibleMovesMade++;
+    state_info->pliesFromNull++;
     uint8_t mask = castlingMask[state_info->lastOriginSquare];
     bool isPassant = false;
 
@@ -2593,12 +2718,11 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
     }
     if (m_turn) // White's move
     {
-        m_moved_piece = m_white_board[state_info->lastOriginSquare];
-        captured_piece = m_black_board[m_last_destination_square];
+        m_moved_piece = whitePieceOn(state_info->lastOriginSquare);
+        captured_piece = blackPieceOn(m_last_destination_square);
 
-        m_white_board[state_info->lastOriginSquare] = 7;
-        m_white_board[m_last_destination_square] = m_moved_piece;
-        m_black_board[m_last_destination_square] = 7;
+        m_board[state_info->lastOriginSquare] = NO_PIECE;
+        m_board[m_last_destination_square] = m_moved_piece;
 
         if (m_moved_piece == 5) // Moving king
         {
@@ -2635,8 +2759,8 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
                 m_pieces_bit[0] |= 32;
 
 
-                m_white_board[7] = 7;
-                m_white_board[5] = 3;
+                m_board[7] = NO_PIECE;
+                m_board[5] = 3;
 
                 state_info->zobristKey ^= zobrist_keys::pieceZobristNumbers[0][3][7] ^ zobrist_keys::pieceZobristNumbers[0][3][5];
 
@@ -2655,8 +2779,8 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
                 m_all_pieces_bit |= 8;
                 m_pieces_bit[0] |= 8;
 
-                m_white_board[0] = 7;
-                m_white_board[3] = 3;
+                m_board[0] = NO_PIECE;
+                m_board[3] = 3;
 
                 state_info->zobristKey ^= zobrist_keys::pieceZobristNumbers[0][3][0] ^ zobrist_keys::pieceZobristNumbers[0][3][3];
 
@@ -2690,7 +2814,7 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
                 m_promoted_piece = move.getPromotingPiece() + 1;
                 m_pieces[0][m_promoted_piece] |= (state_info->lastDestinationBit);
 
-                m_white_board[m_last_destination_square] = m_promoted_piece;
+                m_board[m_last_destination_square] = m_promoted_piece;
                 // Direct check and discover check
                 if (not state_info->isCheck)
                     state_info->isCheck = state_info->previous->checkBits[m_promoted_piece] & state_info->lastDestinationBit || isPromotionCheck(m_promoted_piece, m_last_destination_square);
@@ -2709,7 +2833,7 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
 
                 if (not(state_info->isCheck))
                     state_info->isCheck = isDiscoverCheckAfterPassant();
-                m_black_board[m_last_destination_square - 8] = 7;
+                m_board[m_last_destination_square - 8] = NO_PIECE;
                 // Set NNUEU input
                 removeOnInput(64 * 5 + m_last_destination_square - 8);
                 isPassant = true;
@@ -2764,12 +2888,11 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
     }
     else // Black's move
     {
-        m_moved_piece = m_black_board[state_info->lastOriginSquare];
-        captured_piece = m_white_board[m_last_destination_square];
+        m_moved_piece = blackPieceOn(state_info->lastOriginSquare);
+        captured_piece = whitePieceOn(m_last_destination_square);
 
-        m_black_board[state_info->lastOriginSquare] = 7;
-        m_black_board[m_last_destination_square] = m_moved_piece;
-        m_white_board[m_last_destination_square] = 7;
+        m_board[state_info->lastOriginSquare] = NO_PIECE;
+        m_board[m_last_destination_square] = m_moved_piece + 6;
 
         if (m_moved_piece == 5) // Moving king
         {
@@ -2808,8 +2931,8 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
                 m_all_pieces_bit |= 2305843009213693952ULL;
                 m_pieces_bit[1] |= 2305843009213693952ULL;
 
-                m_black_board[63] = 7;
-                m_black_board[61] = 3;
+                m_board[63] = NO_PIECE;
+                m_board[61] = 9;
 
                 state_info->zobristKey ^= zobrist_keys::pieceZobristNumbers[1][3][63] ^ zobrist_keys::pieceZobristNumbers[1][3][61];
                 // Set NNUEU input
@@ -2828,8 +2951,8 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
                 m_all_pieces_bit |= 576460752303423488ULL;
                 m_pieces_bit[1] |= 576460752303423488ULL;
 
-                m_black_board[56] = 7;
-                m_black_board[59] = 3;
+                m_board[56] = NO_PIECE;
+                m_board[59] = 9;
 
                 state_info->zobristKey ^= zobrist_keys::pieceZobristNumbers[1][3][56] ^ zobrist_keys::pieceZobristNumbers[1][3][59];
                 // Set NNUEU input
@@ -2860,7 +2983,7 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
                 m_promoted_piece = move.getPromotingPiece() + 1;
                 m_pieces[1][m_promoted_piece] |= (state_info->lastDestinationBit);
 
-                m_black_board[m_last_destination_square] = m_promoted_piece;
+                m_board[m_last_destination_square] = m_promoted_piece + 6;
                 // Direct check and discover checks
                 if (not state_info->isCheck)
                     state_info->isCheck = state_info->previous->checkBits[m_promoted_piece] & state_info->lastDestinationBit || isPromotionCheck(m_promoted_piece, m_last_destination_square);
@@ -2878,7 +3001,7 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
                 captured_piece = 0;
                 if (not state_info->isCheck)
                     state_info->isCheck = isDiscoverCheckAfterPassant();
-                m_white_board[m_last_destination_square + 8] = 7;
+                m_board[m_last_destination_square + 8] = NO_PIECE;
                 // Set NNUEU input
                 removeOnInput(m_last_destination_square + 8);
                 isPassant = true;
@@ -2965,14 +3088,8 @@ void BitPosition::makeMove(T move, StateInfo &new_state_info)
     //     setCheckInfo();
     //     printChecksInfo();
     // }
-    // Note, we store the zobrist key in it's array when making the move. However the rest of the ply info
-    // is stored when making the next move to be able to go back.
-    // So we store it in the m_ply+1 position because the initial position (or position after capture) is the m_ply 0.
-
     m_ply++;
 
-    m_zobrist_keys_array[127 - m_ply] = state_info->zobristKey;
-
     // uint64_t old_all_pieces_bit = m_all_pieces_bit;
     // uint64_t old_pieces_bit[2] = {m_pieces_bit[0], m_pieces_bit[1]};
     // setAllPiecesBits();
@@ -3111,8 +3228,6 @@ void BitPosition::unmakeMove(T move)
     // If a move was made before, that means previous position had blockers set (which we restore from ply info)
     m_blockers_set = true;
 
-    m_zobrist_keys_array[127 - m_ply] = 0;
-
     m_ply--;
     int previous_captured_piece{state_info->capturedPiece};
 
@@ -3120,6 +3235,8 @@ void BitPosition::unmakeMove(T move)
     // std::memcpy(state_info->previous->inputWhiteTurn, state_info->inputWhiteTurn, 16);
     // std::memcpy(state_info->previous->inputBlackTurn, state_info->inputBlackTurn, 16);
     state_info = state_info->previous;
+    // The last destination is needed again for refutations (getBestRefutation)
+    m_last_destination_square = getLeastSignificantBitIndex(state_info->lastDestinationBit);
 
     // Get move info
     int origin_square{move.getOriginSquare()};
@@ -3132,7 +3249,7 @@ void BitPosition::unmakeMove(T move)
     m_pieces_bit[m_turn] ^= (origin_bit | destination_bit);
     if (m_turn) // Last move was black
     {
-        int moved_piece = m_black_board[destination_square];
+        int moved_piece = blackPieceOn(destination_square);
         // Castling, Passant and promotions
         if (move.getData() & 0b0100000000000000)
         {
@@ -3151,9 +3268,9 @@ void BitPosition::unmakeMove(T move)
                 m_pieces[1][5] = (1ULL << 60);
                 m_king_position[1] = 60;
 
-                m_black_board[63] = 3;
-                m_black_board[61] = 7;
-                m_white_board[destination_square] = previous_captured_piece;
+                m_board[63] = 9;
+                m_board[61] = NO_PIECE;
+                m_board[destination_square] = boardPiece(previous_captured_piece, 0);
             }
 
             // Unmake queenside castling
@@ -3171,9 +3288,9 @@ void BitPosition::unmakeMove(T move)
                 m_pieces[1][5] = (1ULL << 60);
                 m_king_position[1] = 60;
 
-                m_black_board[56] = 3;
-                m_black_board[59] = 7;
-                m_white_board[destination_square] = previous_captured_piece;
+                m_board[56] = 9;
+                m_board[59] = NO_PIECE;
+                m_board[destination_square] = boardPiece(previous_captured_piece, 0);
             }
 
             // Unmaking black promotions
@@ -3207,7 +3324,7 @@ void BitPosition::unmakeMove(T move)
                     m_pieces_bit[0] |= destination_bit;
                     m_all_pieces_bit |= destination_bit;
                 }
-                m_white_board[destination_square] = previous_captured_piece;
+                m_board[destination_square] = boardPiece(previous_captured_piece, 0);
             }
             else // Passant
             {
@@ -3216,7 +3333,8 @@ void BitPosition::unmakeMove(T move)
                 m_pieces[0][0] |= shift_up(destination_bit);
                 m_pieces_bit[0] |= shift_up(destination_bit);
                 m_all_pieces_bit |= shift_up(destination_bit);
-                m_white_board[destination_square + 8] = 0;
+                m_board[destination_square + 8] = 0;
+                m_board[destination_square] = NO_PIECE;
             }
         }
 
@@ -3241,14 +3359,13 @@ void BitPosition::unmakeMove(T move)
                 m_pieces_bit[0] |= destination_bit;
                 m_all_pieces_bit |= destination_bit;
             }
-            m_white_board[destination_square] = previous_captured_piece;
+            m_board[destination_square] = boardPiece(previous_captured_piece, 0);
         }
-        m_black_board[destination_square] = 7;
-        m_black_board[origin_square] = moved_piece;
+        m_board[origin_square] = moved_piece + 6;
     }
     else // Last move was white
     {
-        int moved_piece = m_white_board[destination_square];
+        int moved_piece = whitePieceOn(destination_square);
         // Special moves
         if (move.getData() & 0b0100000000000000)
         {
@@ -3267,9 +3384,9 @@ void BitPosition::unmakeMove(T move)
                 m_pieces[0][5] = (1ULL << 4);
                 m_king_position[0] = 4;
 
-                m_white_board[7] = 3;
-                m_white_board[5] = 7;
-                m_black_board[destination_square] = previous_captured_piece;
+                m_board[7] = 3;
+                m_board[5] = NO_PIECE;
+                m_board[destination_square] = boardPiece(previous_captured_piece, 1);
             }
 
             // Unmake queenside castling
@@ -3287,9 +3404,9 @@ void BitPosition::unmakeMove(T move)
                 m_pieces[0][5] = (1ULL << 4);
                 m_king_position[0] = 4;
 
-                m_white_board[0] = 3;
-                m_white_board[3] = 7;
-                m_black_board[destination_square] = previous_captured_piece;
+                m_board[0] = 3;
+                m_board[3] = NO_PIECE;
+                m_board[destination_square] = boardPiece(previous_captured_piece, 1);
             }
 
             // Unmaking promotions
@@ -3323,7 +3440,7 @@ void BitPosition::unmakeMove(T move)
                     m_pieces_bit[1] |= destination_bit;
                     m_all_pieces_bit |= destination_bit;
                 }
-                m_black_board[destination_square] = previous_captured_piece;
+                m_board[destination_square] = boardPiece(previous_captured_piece, 1);
             }
             else // Passant
             {
@@ -3332,7 +3449,8 @@ void BitPosition::unmakeMove(T move)
                 m_pieces[1][0] |= shift_down(destination_bit);
                 m_pieces_bit[1] |= shift_down(destination_bit);
                 m_all_pieces_bit |= shift_down(destination_bit);
-                m_black_board[destination_square - 8] = 0;
+                m_board[destination_square - 8] = 6;
+                m_board[destination_square] = NO_PIECE;
             }
         }
 
@@ -3357,10 +3475,9 @@ void BitPosition::unmakeMove(T move)
                 m_pieces_bit[1] |= destination_bit;
                 m_all_pieces_bit |= destination_bit;
             }
-            m_black_board[destination_square] = previous_captured_piece;
+            m_board[destination_square] = boardPiece(previous_captured_piece, 1);
         }
-        m_white_board[destination_square] = 7;
-        m_white_board[origin_square] = moved_piece;
+        m_board[origin_square] = moved_piece;
     }
 
     m_turn = not m_turn;
@@ -3491,8 +3608,8 @@ void BitPosition::makeCapture(T move, StateInfo& new_state_info)
     // Save irreversible aspects of position and create a new state
     // Irreversible aspects include: castlingRights, fiftyMoveCount, zobristKey and pSquare
     std::memcpy(&new_state_info, state_info, offsetof(StateInfo, pSquare));
+    copyAccumulators(new_state_info, *state_info);
     new_state_info.previous = state_info;
-    state_info->next = &new_state_info;
     state_info = &new_state_info;
 
     // std::string fen_before{toFenString()}; // Debugging purposes
@@ -3525,8 +3642,8 @@ void BitPosition::makeCapture(T move, StateInfo& new_state_info)
 
     if (m_turn) // White's move
     {
-        m_moved_piece = m_white_board[state_info->lastOriginSquare];
-        captured_piece = m_black_board[m_last_destination_square];
+        m_moved_piece = whitePieceOn(state_info->lastOriginSquare);
+        captured_piece = blackPieceOn(m_last_destination_square);
 
         // Promotions
         if (move.getData() & 0b0100000000000000)
@@ -3544,10 +3661,10 @@ void BitPosition::makeCapture(T move, StateInfo& new_state_info)
                 m_pieces[1][captured_piece] &= ~(state_info->lastDestinationBit);
                 // Set NNUE input
                 removeOnInput(64 * (5 + captured_piece) + m_last_destination_square);
-                m_black_board[m_last_destination_square] = 7;
+                m_board[m_last_destination_square] = NO_PIECE;
             }
-            m_white_board[state_info->lastOriginSquare] = 7;
-            m_white_board[m_last_destination_square] = 4;
+            m_board[state_info->lastOriginSquare] = NO_PIECE;
+            m_board[m_last_destination_square] = 4;
 
             // Direct or discover checks
             state_info->isCheck = isQueenCheck(m_last_destination_square) or isDiscoverCheck(state_info->lastOriginSquare, m_last_destination_square);
@@ -3586,15 +3703,14 @@ void BitPosition::makeCapture(T move, StateInfo& new_state_info)
             // Set NNUE input
             removeOnInput(64 * (5 + captured_piece) + m_last_destination_square);
 
-            m_white_board[state_info->lastOriginSquare] = 7;
-            m_white_board[m_last_destination_square] = m_moved_piece;
-            m_black_board[m_last_destination_square] = 7;
+            m_board[state_info->lastOriginSquare] = NO_PIECE;
+            m_board[m_last_destination_square] = m_moved_piece;
         }
     }
     else // Black's move
     {
-        m_moved_piece = m_black_board[state_info->lastOriginSquare];
-        captured_piece = m_white_board[m_last_destination_square];
+        m_moved_piece = blackPieceOn(state_info->lastOriginSquare);
+        captured_piece = whitePieceOn(m_last_destination_square);
 
         // Promotions
         if (move.getData() & 0b0100000000000000)
@@ -3612,10 +3728,10 @@ void BitPosition::makeCapture(T move, StateInfo& new_state_info)
                 m_pieces[0][captured_piece] &= ~(state_info->lastDestinationBit);
                 // Set NNUE input
                 removeOnInput(64 * captured_piece + m_last_destination_square);
-                m_white_board[m_last_destination_square] = 7;
+                m_board[m_last_destination_square] = NO_PIECE;
             }
-            m_black_board[state_info->lastOriginSquare] = 7;
-            m_black_board[m_last_destination_square] = 4;
+            m_board[state_info->lastOriginSquare] = NO_PIECE;
+            m_board[m_last_destination_square] = 10;
 
             // Direct or discover checks
             state_info->isCheck = isQueenCheck(m_last_destination_square) or isDiscoverCheck(state_info->lastOriginSquare, m_last_destination_square);
@@ -3655,9 +3771,8 @@ void BitPosition::makeCapture(T move, StateInfo& new_state_info)
             // Set NNUE input
             removeOnInput(64 * captured_piece + m_last_destination_square);
 
-            m_black_board[state_info->lastOriginSquare] = 7;
-            m_black_board[m_last_destination_square] = m_moved_piece;
-            m_white_board[m_last_destination_square] = 7;
+            m_board[state_info->lastOriginSquare] = NO_PIECE;
+            m_board[m_last_destination_square] = m_moved_piece + 6;
         }
     }
     // Debugging
@@ -3817,6 +3932,8 @@ void BitPosition::unmakeCapture(T move)
 
     // Update irreversible aspects
     state_info = state_info->previous;
+    // The last destination is needed again for refutations (getBestRefutation)
+    m_last_destination_square = getLeastSignificantBitIndex(state_info->lastDestinationBit);
 
     // Get move info
     int origin_square{move.getOriginSquare()};
@@ -3830,7 +3947,7 @@ void BitPosition::unmakeCapture(T move)
 
     if (m_turn) // Last move was black
     {
-        int moved_piece = m_black_board[destination_square];
+        int moved_piece = blackPieceOn(destination_square);
         // Promotions
         if (move.getData() & 0b0100000000000000)
         {
@@ -3866,13 +3983,12 @@ void BitPosition::unmakeCapture(T move)
             // Unmaking captures
             m_pieces[0][previous_captured_piece] |= destination_bit;
         }
-        m_black_board[destination_square] = 7;
-        m_black_board[origin_square] = moved_piece;
-        m_white_board[destination_square] = previous_captured_piece;
+        m_board[origin_square] = moved_piece + 6;
+        m_board[destination_square] = boardPiece(previous_captured_piece, 0);
     }
     else // Last move was white
     {
-        int moved_piece = m_white_board[destination_square];
+        int moved_piece = whitePieceOn(destination_square);
         // Passant and promotions
         if (move.getData() & 0b0100000000000000)
         {
@@ -3910,9 +4026,8 @@ void BitPosition::unmakeCapture(T move)
             // Unmaking captures
             m_pieces[1][previous_captured_piece] |= destination_bit;
         }
-        m_white_board[destination_square] = 7;
-        m_white_board[origin_square] = moved_piece;
-        m_black_board[destination_square] = previous_captured_piece;
+        m_board[origin_square] = moved_piece;
+        m_board[destination_square] = boardPiece(previous_captured_piece, 1);
     }
     // BitPosition::setAllPiecesBits();
     m_turn = not m_turn;
@@ -4042,6 +4157,97 @@ void BitPosition::unmakeCapture(T move)
     // }
 }
 
+void BitPosition::makeNullMove(StateInfo &new_state_info)
+// Pass the turn to the opponent without moving any piece. Only called when not in check.
+// The NNUE accumulators are copied with the state and left untouched, since no piece moves.
+{
+    std::memcpy(&new_state_info, state_info, offsetof(StateInfo, lastDestinationBit));
+    copyAccumulators(new_state_info, *state_info);
+    new_state_info.previous = state_info;
+    state_info = &new_state_info;
+
+    m_blockers_set = false;
+
+    // Passant square is lost after passing
+    state_info->zobristKey ^= zobrist_keys::passantSquaresZobristNumbers[state_info->pSquare];
+    state_info->pSquare = 0;
+    state_info->zobristKey ^= zobrist_keys::passantSquaresZobristNumbers[0];
+    state_info->zobristKey ^= zobrist_keys::blackToMoveZobristNumber;
+
+    // No repetitions can go through a null move, the 50 move count goes on
+    state_info->pliesFromNull = 0;
+
+    // No refutations nor checks after a null move
+    state_info->lastDestinationBit = 0;
+    state_info->capturedPiece = 7;
+    state_info->isCheck = false;
+
+    m_turn = not m_turn;
+    m_ply++;
+}
+void BitPosition::unmakeNullMove()
+{
+    m_blockers_set = true;
+
+    m_ply--;
+
+    state_info = state_info->previous;
+    m_turn = not m_turn;
+}
+
+// Copy-make
+BoardSnapshot BitPosition::takeSnapshot() const
+{
+    BoardSnapshot snapshot;
+    std::memcpy(snapshot.pieces, m_pieces, sizeof(m_pieces));
+    snapshot.piecesBit[0] = m_pieces_bit[0];
+    snapshot.piecesBit[1] = m_pieces_bit[1];
+    snapshot.allPiecesBit = m_all_pieces_bit;
+    snapshot.stateInfo = state_info;
+    snapshot.ply = m_ply;
+    snapshot.lastDestinationSquare = m_last_destination_square;
+    snapshot.kingPosition[0] = static_cast<int8_t>(m_king_position[0]);
+    snapshot.kingPosition[1] = static_cast<int8_t>(m_king_position[1]);
+    snapshot.turn = m_turn;
+    snapshot.blockersSet = m_blockers_set;
+    return snapshot;
+}
+
+void BitPosition::restoreSnapshot(const BoardSnapshot &snapshot, Move move)
+// Goes back to the position of the snapshot, taken before making move (with makeMove, makeCapture or makeCaptureTest).
+// Bitboards are copied back, and only the mailbox squares move changed are looked up in them.
+{
+    std::memcpy(m_pieces, snapshot.pieces, sizeof(m_pieces));
+    m_pieces_bit[0] = snapshot.piecesBit[0];
+    m_pieces_bit[1] = snapshot.piecesBit[1];
+    m_all_pieces_bit = snapshot.allPiecesBit;
+    state_info = snapshot.stateInfo;
+    m_ply = snapshot.ply;
+    m_last_destination_square = snapshot.lastDestinationSquare;
+    m_king_position[0] = snapshot.kingPosition[0];
+    m_king_position[1] = snapshot.kingPosition[1];
+    m_turn = snapshot.turn;
+    m_blockers_set = snapshot.blockersSet;
+
+    // Castling rooks and passant captured pawns are on the origin or destination rows
+    uint64_t changed_squares{(1ULL << move.getOriginSquare()) | (1ULL << move.getDestinationSquare())};
+    if (move.getData() & 0b0100000000000000)
+        changed_squares |= (FIRST_ROW_BITBOARD << (move.getOriginSquare() & 56)) | (FIRST_ROW_BITBOARD << (move.getDestinationSquare() & 56));
+    while (changed_squares)
+    {
+        int square{popLeastSignificantBit(changed_squares)};
+        uint64_t bit{1ULL << square};
+        m_board[square] = NO_PIECE;
+        for (int piece = 0; piece < 6; ++piece)
+        {
+            if (m_pieces[0][piece] & bit)
+                m_board[square] = piece;
+            else if (m_pieces[1][piece] & bit)
+                m_board[square] = piece + 6;
+        }
+    }
+}
+
 // Game ending functions
 bool BitPosition::isMate() const
 // This is called only in quiesence search, after having no available captures
@@ -4341,7 +4547,8 @@ Move *BitPosition::inCheckPassantCaptures(Move *&move_list) const
     return move_list;
 }
 
-Move *BitPosition::pawnNonCapturesNonQueenProms(Move *&move_list) const
+template <typename T>
+T *BitPosition::pawnNonCapturesNonQueenProms(T *&move_list) const
 {
     if (m_turn)
     {
@@ -4437,7 +4644,8 @@ Move *BitPosition::pawnNonCapturesNonQueenProms(Move *&move_list) const
     }
     return move_list;
 }
-Move *BitPosition::knightNonCaptures(Move*& move_list) const
+template <typename T>
+T *BitPosition::knightNonCaptures(T *&move_list) const
 {
     if (m_turn)
     {
@@ -4461,7 +4669,8 @@ Move *BitPosition::knightNonCaptures(Move*& move_list) const
     }
     return move_list;
 }
-Move *BitPosition::bishopNonCaptures(Move *&move_list) const
+template <typename T>
+T *BitPosition::bishopNonCaptures(T *&move_list) const
 {
     if (m_turn)
     {
@@ -4485,7 +4694,8 @@ Move *BitPosition::bishopNonCaptures(Move *&move_list) const
     }
     return move_list;
 }
-Move *BitPosition::rookNonCaptures(Move*& move_list) const
+template <typename T>
+T *BitPosition::rookNonCaptures(T *&move_list) const
 {
     if (m_turn)
     {
@@ -4509,7 +4719,8 @@ Move *BitPosition::rookNonCaptures(Move*& move_list) const
     }
     return move_list;
 }
-Move *BitPosition::queenNonCaptures(Move *&move_list) const
+template <typename T>
+T *BitPosition::queenNonCaptures(T *&move_list) const
 {
     if (m_turn)
     {
@@ -4533,7 +4744,8 @@ Move *BitPosition::queenNonCaptures(Move *&move_list) const
     }
     return move_list;
 }
-Move *BitPosition::kingNonCaptures(Move *&move_list) const
+template <typename T>
+T *BitPosition::kingNonCaptures(T *&move_list) const
 {
     if (m_turn)
     {
@@ -4578,9 +4790,9 @@ void BitPosition::makeCaptureTest(T move, StateInfo &new_state_info)
 {
     // Save irreversible aspects of position and create a new state
     // Irreversible aspects include: castlingRights, fiftyMoveCount, zobristKey and pSquare
-    std::memcpy(&new_state_info, state_info, offsetof(StateInfo, straightPinnedPieces));
+    std::memcpy(&new_state_info, state_info, offsetof(StateInfo, lastDestinationBit));
+    copyAccumulators(new_state_info, *state_info);
     new_state_info.previous = state_info;
-    state_info->next = &new_state_info;
     state_info = &new_state_info;
 
     // std::string fen_before{toFenString()}; // Debugging purposes
@@ -4616,8 +4828,8 @@ void BitPosition::makeCaptureTest(T move, StateInfo &new_state_info)
             if (state_info->lastOriginSquare == 4) // White king from e1
                 state_info->castlingRights &= ~(WHITE_KS | WHITE_QS);
         }
-        m_moved_piece = m_white_board[state_info->lastOriginSquare];
-        captured_piece = m_black_board[m_last_destination_square];
+        m_moved_piece = whitePieceOn(state_info->lastOriginSquare);
+        captured_piece = blackPieceOn(m_last_destination_square);
         // Promotions
         if (move.getData() & 0b0100000000000000)
         {
@@ -4635,7 +4847,7 @@ void BitPosition::makeCaptureTest(T move, StateInfo &new_state_info)
                 m_pieces[1][captured_piece] &= ~(state_info->lastDestinationBit);
                 // Set NNUE input
                 removeOnInput(64 * (5 + captured_piece) + m_last_destination_square);
-                m_black_board[m_last_destination_square] = 7;
+                m_board[m_last_destination_square] = NO_PIECE;
 
                 // CLEAR CASTLING RIGHTS if capturing an enemy rook on the corner
                 uint8_t mask = castlingMask[m_last_destination_square];
@@ -4649,8 +4861,8 @@ void BitPosition::makeCaptureTest(T move, StateInfo &new_state_info)
                     state_info->zobristKey ^= zobrist_keys::castlingRightsZobristNumbers[state_info->castlingRights];
                 }
             }
-            m_white_board[state_info->lastOriginSquare] = 7;
-            m_white_board[m_last_destination_square] = 4;
+            m_board[state_info->lastOriginSquare] = NO_PIECE;
+            m_board[m_last_destination_square] = 4;
 
             // Direct or discover checks
             state_info->isCheck = isQueenCheck(m_last_destination_square) or isDiscoverCheck(state_info->lastOriginSquare, m_last_destination_square);
@@ -4702,9 +4914,8 @@ void BitPosition::makeCaptureTest(T move, StateInfo &new_state_info)
                     state_info->zobristKey ^= zobrist_keys::castlingRightsZobristNumbers[state_info->castlingRights];
                 }
             }
-            m_white_board[state_info->lastOriginSquare] = 7;
-            m_white_board[m_last_destination_square] = m_moved_piece;
-            m_black_board[m_last_destination_square] = 7;
+            m_board[state_info->lastOriginSquare] = NO_PIECE;
+            m_board[m_last_destination_square] = m_moved_piece;
         }
     }
     else // Black's move
@@ -4729,8 +4940,8 @@ void BitPosition::makeCaptureTest(T move, StateInfo &new_state_info)
             if (state_info->lastOriginSquare == 60) // Black king from e8
                 state_info->castlingRights &= ~(BLACK_KS | BLACK_QS);
         }
-        m_moved_piece = m_black_board[state_info->lastOriginSquare];
-        captured_piece = m_white_board[m_last_destination_square];
+        m_moved_piece = blackPieceOn(state_info->lastOriginSquare);
+        captured_piece = whitePieceOn(m_last_destination_square);
         // Promotions
         if (move.getData() & 0b0100000000000000)
         {
@@ -4748,7 +4959,7 @@ void BitPosition::makeCaptureTest(T move, StateInfo &new_state_info)
                 m_pieces[0][captured_piece] &= ~(state_info->lastDestinationBit);
                 // Set NNUE input
                 removeOnInput(64 * captured_piece + m_last_destination_square);
-                m_white_board[m_last_destination_square] = 7;
+                m_board[m_last_destination_square] = NO_PIECE;
 
                 // CLEAR CASTLING RIGHTS if capturing an enemy rook on the corner
                 uint8_t mask = castlingMask[m_last_destination_square];
@@ -4762,8 +4973,8 @@ void BitPosition::makeCaptureTest(T move, StateInfo &new_state_info)
                     state_info->zobristKey ^= zobrist_keys::castlingRightsZobristNumbers[state_info->castlingRights];
                 }
             }
-            m_black_board[state_info->lastOriginSquare] = 7;
-            m_black_board[m_last_destination_square] = 4;
+            m_board[state_info->lastOriginSquare] = NO_PIECE;
+            m_board[m_last_destination_square] = 10;
 
             // Direct or discover checks
             state_info->isCheck = isQueenCheck(m_last_destination_square) or isDiscoverCheck(state_info->lastOriginSquare, m_last_destination_square);
@@ -4816,9 +5027,8 @@ void BitPosition::makeCaptureTest(T move, StateInfo &new_state_info)
                     state_info->zobristKey ^= zobrist_keys::castlingRightsZobristNumbers[state_info->castlingRights];
                 }
             }
-            m_black_board[state_info->lastOriginSquare] = 7;
-            m_black_board[m_last_destination_square] = m_moved_piece;
-            m_white_board[m_last_destination_square] = 7;
+            m_board[state_info->lastOriginSquare] = NO_PIECE;
+            m_board[m_last_destination_square] = m_moved_piece + 6;
         }
     }
     BitPosition::setAllPiecesBits();
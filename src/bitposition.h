@@ -10,7 +10,9 @@
 #include <vector>
 #include <unordered_set>
 #include <cstring>
+#include <cstddef> // For offsetof
 #include <algorithm>
+#include <type_traits> // For std::is_trivially_copyable_v
 
 extern bool ENGINEISWHITE;
 
@@ -36,6 +38,9 @@ extern int16_t secondLayerBiases[8];
 extern int16_t thirdLayerBiases[4];
 extern int16_t finalLayerBias;
 
+// Value of empty squares in BitPosition::m_board
+constexpr uint8_t NO_PIECE{12};
+
 enum CastlingRights : uint8_t
 {
     WHITE_KS = 1 << 0,  // 0x01 (bit 0)
@@ -44,39 +49,72 @@ enum CastlingRights : uint8_t
     BLACK_QS = 1 << 3   // 0x08 (bit 3)
 };
 
+// State of a position that can't be recomputed when unmaking a move.
+// Laid out so that everything make, unmake and the move generators read is in the first 64 bytes,
+// and so that few bytes are copied from the previous state (up to lastDestinationBit, plus the accumulators).
 struct StateInfo
 {
     // Copied when making a move
     int8_t castlingRights;  // Bits: 0=WhiteKS, 1=WhiteQS, 2=BlackKS, 3=BlackQS
-    int16_t inputWhiteTurn[8]; // NUUEU Input
-    int16_t inputBlackTurn[8]; // NNUEU Input
-    int reversibleMovesMade; // Used for three-fold checks
-    int pSquare; // Used to update zobrist key
+    int16_t reversibleMovesMade; // Used for three-fold checks
+    int16_t pliesFromNull; // Plies since the last null move, no repetition can go through one
     // Bellow this. Not copied when making a capture (will be recomputed anyhow), used for unmaking captures
+    int8_t pSquare; // Passant square (0 if there is none), used to update zobrist key
     uint64_t zobristKey;
 
     // Bellow this. Not copied when making a move (will be recomputed anyhow), used for unmaking moves
+    uint64_t lastDestinationBit; // For refutation moves after unmaking a Ttmove
     uint64_t straightPinnedPieces;
     uint64_t diagonalPinnedPieces;
     uint64_t pinnedPieces;
-    uint64_t blockersForKing;
-    uint64_t lastDestinationBit; // For refutation moves after unmaking a Ttmove
-    int capturedPiece;
-    int lastOriginSquare; // For when calling setCheckInfo()
+    int8_t capturedPiece;
+    int8_t lastOriginSquare; // For when calling setCheckInfo()
     bool isCheck;
-    uint64_t checkBits[5];
 
-    // Pointers to previous and next state
+    // Pointer to previous state
     StateInfo *previous;
-    StateInfo *next;
+
+    // Read less often
+    uint64_t checkBits[5];
+    uint64_t blockersForKing;
+
+    // NNUEU accumulators, copied when making a move or a capture and updated incrementally
+    alignas(16) int16_t inputWhiteTurn[8]; // NNUEU Input
+    int16_t inputBlackTurn[8]; // NNUEU Input
 };
+static_assert(offsetof(StateInfo, previous) + sizeof(StateInfo *) <= 64, "Hot StateInfo fields should fit in 64 bytes");
+static_assert(sizeof(StateInfo) == 144, "StateInfo should stay compact");
+
+// Copies the accumulators of the previous state into a new one, they are updated with the move afterwards
+inline void copyAccumulators(StateInfo &new_state_info, const StateInfo &state_info)
+{
+    std::memcpy(new_state_info.inputWhiteTurn, state_info.inputWhiteTurn, sizeof(state_info.inputWhiteTurn));
+    std::memcpy(new_state_info.inputBlackTurn, state_info.inputBlackTurn, sizeof(state_info.inputBlackTurn));
+}
+
+// Board part of a position: everything makeMove and makeCapture change apart from the mailboxes and the new StateInfo.
+// It is plain data of 144 bytes, for copy-make: take a snapshot before making a move and restore it
+// instead of calling unmakeMove or unmakeCapture. Irreversible aspects stay in the StateInfo list as usual.
+struct BoardSnapshot
+{
+    uint64_t pieces[2][6];
+    uint64_t piecesBit[2];
+    uint64_t allPiecesBit;
+    StateInfo *stateInfo;
+    int ply;
+    int lastDestinationSquare;
+    int8_t kingPosition[2];
+    bool turn;
+    bool blockersSet;
+};
+static_assert(std::is_trivially_copyable_v<BoardSnapshot>, "BoardSnapshot must be copyable with memcpy");
+static_assert(sizeof(BoardSnapshot) == 144, "BoardSnapshot should stay compact");
 
 class BitPosition
 {
 private:
-    // Board of color pieces 7s where no pieces
-    int m_white_board[64];
-    int m_black_board[64];
+    // Piece on each square: 0 to 5 for white pieces, 6 to 11 for black pieces (as in movingPiece), NO_PIECE if empty
+    uint8_t m_board[64];
 
     // 64-bit to represent pieces on board
     uint64_t m_pieces[2][6];
@@ -107,9 +145,6 @@ private:
 
     // Ply number
     int m_ply{0};
-    
-    // Ply info arrays
-    std::array<uint64_t, 128> m_zobrist_keys_array{};
 
     StateInfo *state_info;
     int last_nnueu_king_position[2];
@@ -129,8 +164,7 @@ public:
         m_pieces[0][0] = 0, m_pieces[0][1] = 0, m_pieces[0][2] = 0, m_pieces[0][3] = 0, m_pieces[0][4] = 0, m_pieces[0][5] = 0;
         m_pieces[1][0] = 0, m_pieces[1][1] = 0, m_pieces[1][2] = 0, m_pieces[1][3] = 0, m_pieces[1][4] = 0, m_pieces[1][5] = 0;
 
-        std::fill(std::begin(m_white_board), std::end(m_white_board), 7);
-        std::fill(std::begin(m_black_board), std::end(m_black_board), 7);
+        std::fill(std::begin(m_board), std::end(m_board), NO_PIECE);
         int square = 56; // Start from the top-left corner of the chess board
         for (char c : board)
         {
@@ -149,51 +183,51 @@ public:
                 {
                 case 'P':
                     m_pieces[0][0] |= bit;
-                    m_white_board[square] = 0;
+                    m_board[square] = 0;
                     break;
                 case 'N':
                     m_pieces[0][1] |= bit;
-                    m_white_board[square] = 1;
+                    m_board[square] = 1;
                     break;
                 case 'B':
                     m_pieces[0][2] |= bit;
-                    m_white_board[square] = 2;
+                    m_board[square] = 2;
                     break;
                 case 'R':
                     m_pieces[0][3] |= bit;
-                    m_white_board[square] = 3;
+                    m_board[square] = 3;
                     break;
                 case 'Q':
                     m_pieces[0][4] |= bit;
-                    m_white_board[square] = 4;
+                    m_board[square] = 4;
                     break;
                 case 'K':
                     m_pieces[0][5] |= bit;
-                    m_white_board[square] = 5;
+                    m_board[square] = 5;
                     break;
                 case 'p':
                     m_pieces[1][0] |= bit;
-                    m_black_board[square] = 0;
+                    m_board[square] = 6;
                     break;
                 case 'n':
                     m_pieces[1][1] |= bit;
-                    m_black_board[square] = 1;
+                    m_board[square] = 7;
                     break;
                 case 'b':
                     m_pieces[1][2] |= bit;
-                    m_black_board[square] = 2;
+                    m_board[square] = 8;
                     break;
                 case 'r':
                     m_pieces[1][3] |= bit;
-                    m_black_board[square] = 3;
+                    m_board[square] = 9;
                     break;
                 case 'q':
                     m_pieces[1][4] |= bit;
-                    m_black_board[square] = 4;
+                    m_board[square] = 10;
                     break;
                 case 'k':
                     m_pieces[1][5] |= bit;
-                    m_black_board[square] = 5;
+                    m_board[square] = 11;
                     break;
                 }
                 square++;
@@ -220,8 +254,11 @@ public:
 
         state_info->castlingRights = cr;
 
+        // Passant square, 0 if there is none
         state_info->pSquare = 0;
-        
+        if (enPassant.size() == 2)
+            state_info->pSquare = (enPassant[0] - 'a') + 8 * (enPassant[1] - '1');
+
         setAllPiecesBits();
         setKingPosition();
         setIsCheckOnInitialization();
@@ -305,16 +342,11 @@ public:
     Move *inCheckOrderedCapturesAndKingMoves(Move *&move_list) const;
     Move *inCheckOrderedCaptures(Move *&move_list) const;
 
-    std::vector<Move> orderAllMovesOnFirstIterationFirstTime(std::vector<Move> &moves, Move ttMove) const;
-    std::pair<std::vector<Move>, std::vector<int16_t>> orderAllMovesOnFirstIteration(std::vector<Move> &moves, std::vector<int16_t> &scores) const;
-    std::vector<Move> inCheckMoves() const;
-    std::vector<Move> nonCaptureMoves() const;
+    void orderAllMovesOnFirstIterationFirstTime(MoveList<MAX_MOVES> &moves, Move ttMove) const;
+    void orderAllMovesOnFirstIteration(MoveList<MAX_MOVES> &moves, FixedList<int16_t, MAX_MOVES> &scores) const;
 
     bool isMate() const;
 
-    bool moveIsReseter(Move move);
-    void resetPlyInfo();
-
     template <typename T>
     void makeMove(T move, StateInfo& new_state_info);
     template <typename T>
@@ -325,13 +357,25 @@ public:
     template <typename T>
     void unmakeCapture(T move);
 
+    void makeNullMove(StateInfo &new_state_info);
+    void unmakeNullMove();
+
+    // Copy-make alternative to unmakeMove and unmakeCapture
+    BoardSnapshot takeSnapshot() const;
+    void restoreSnapshot(const BoardSnapshot &snapshot, Move move);
+
     template <typename T>
     void makeCaptureTest(T move, StateInfo &new_state_info);
 
-    std::vector<Move> inCheckAllMoves();
-    std::vector<Move> allMoves();
+    MoveList<MAX_MOVES> inCheckAllMoves();
+    MoveList<MAX_MOVES> allMoves();
 
     bool isDraw() const;
+    bool hasUpcomingRepetition(int ply_from_root) const;
+
+    // Static exchange evaluation
+    uint64_t attackersTo(int square, uint64_t occupied) const;
+    bool seeGe(Move move, int threshold = 0) const;
 
     int aBMoveValue(Move move) const
     {
@@ -339,7 +383,7 @@ public:
         if (move.getData() & 0b0100000000000000)
         {
             // Promotions
-            if (m_turn && m_white_board[move.getOriginSquare()] == 0)
+            if (m_turn && m_board[move.getOriginSquare()] == 0)
                 return 30;
             // Castling
             return 2;
@@ -348,26 +392,64 @@ public:
         int score = 0;
         if (m_turn)
         {
-            int piece_at = m_black_board[move.getDestinationSquare()];
+            int piece_at = blackPieceOn(move.getDestinationSquare());
             if (piece_at != 7)
                 score += piece_at + 2;
 
-            piece_at = m_white_board[move.getOriginSquare()];
+            piece_at = whitePieceOn(move.getOriginSquare());
             if (piece_at != 7 && piece_at != 5)
                 score -= piece_at;
         }
         else
         {
-            int piece_at = m_white_board[move.getDestinationSquare()];
+            int piece_at = whitePieceOn(move.getDestinationSquare());
             if (piece_at != 7)
                 score += piece_at + 2;
 
-            piece_at = m_black_board[move.getOriginSquare()];
+            piece_at = blackPieceOn(move.getOriginSquare());
             if (piece_at != 7 && piece_at != 5)
                 score -= piece_at;
         }
         return score;
     }
+    // Piece type (0 to 5) of the white or black piece on a square, 7 if there is no piece of that colour
+    int whitePieceOn(int square) const { return m_board[square] < 6 ? m_board[square] : 7; }
+    int blackPieceOn(int square) const { return static_cast<unsigned>(m_board[square] - 6) < 6 ? m_board[square] - 6 : 7; }
+    // Value in m_board of a piece type of a colour (0 white, 1 black), where piece type 7 is no piece
+    static uint8_t boardPiece(int piece, int color) { return piece == 7 ? NO_PIECE : piece + 6 * color; }
+
+    // Quiet moves are neither captures nor special moves (promotions, passant or castling)
+    bool isQuiet(Move move) const
+    {
+        if (move.getData() & 0b0100000000000000)
+            return false;
+        return m_board[move.getDestinationSquare()] == NO_PIECE;
+    }
+    // Whether a quiet move gives check, to decide on pruning before making it.
+    // Uses the check bits and blockers of the position, set before generating its moves.
+    bool givesCheck(Move move) const;
+    // Piece moved by the side to move, 0-5 for white and 6-11 for black (for the history tables)
+    int movingPiece(Move move) const
+    {
+        return m_board[move.getOriginSquare()];
+    }
+    // Destination square of the last move made, -1 after a null move
+    int previousDestination() const
+    {
+        if (state_info->lastDestinationBit == 0)
+            return -1;
+        return getLeastSignificantBitIndex(state_info->lastDestinationBit);
+    }
+    // Piece that made the last move (as in movingPiece), -1 after a null move
+    int previousPiece() const
+    {
+        int square = previousDestination();
+        if (square == -1)
+            return -1;
+        if (m_board[square] == NO_PIECE)
+            return -1;
+        return m_board[square];
+    }
     int qSMoveValue(Move move) const
     // Captures and queen promotions
     {
@@ -380,13 +462,13 @@ public:
         int score = 0;
         if (m_turn)
         {
-            int piece_at = m_black_board[move.getDestinationSquare()];
+            int piece_at = blackPieceOn(move.getDestinationSquare());
             if (piece_at != 7)
                 score += piece_at + 1;
         }
         else
         {
-            int piece_at = m_white_board[move.getDestinationSquare()];
+            int piece_at = whitePieceOn(move.getDestinationSquare());
             if (piece_at != 7)
                 score += piece_at + 1;
         }
@@ -410,6 +492,18 @@ public:
 
     inline StateInfo *get_state_info() const { return state_info; }
 
+    // For copies of a position used by another thread: the copy gets its own copy of the current state,
+    // so that making and unmaking moves on it never writes to the original position's states.
+    // The copy has no states before it, so repetitions are only looked for after it.
+    void detachStateInfo(StateInfo &own_state_info)
+    {
+        own_state_info = *state_info;
+        own_state_info.previous = nullptr;
+        own_state_info.reversibleMovesMade = 0;
+        own_state_info.pliesFromNull = 0;
+        state_info = &own_state_info;
+    }
+
     // NNUEU updates
     // Helper functions to update the input vector
     // They are used in bitposition.cpp inside makeCapture.
@@ -600,12 +694,18 @@ public:
     Move *inCheckPawnBlocksNonQueenProms(Move *&move_list) const;
     Move *inCheckPawnCapturesNonQueenProms(Move *&move_list) const;
     Move *inCheckPassantCaptures(Move *&move_list) const;
-    Move *pawnNonCapturesNonQueenProms(Move *&move_list) const;
-    Move *knightNonCaptures(Move *&move_list) const;
-    Move *bishopNonCaptures(Move *&move_list) const;
-    Move *rookNonCaptures(Move *&move_list) const;
-    Move *queenNonCaptures(Move *&move_list) const;
-    Move *kingNonCaptures(Move *&move_list) const;
+    template <typename T>
+    T *pawnNonCapturesNonQueenProms(T *&move_list) const;
+    template <typename T>
+    T *knightNonCaptures(T *&move_list) const;
+    template <typename T>
+    T *bishopNonCaptures(T *&move_list) const;
+    template <typename T>
+    T *rookNonCaptures(T *&move_list) const;
+    template <typename T>
+    T *queenNonCaptures(T *&move_list) const;
+    template <typename T>
+    T *kingNonCaptures(T *&move_list) const;
     Move *kingNonCapturesInCheck(Move *&move_list) const;
 
     // Simple member function definitions
@@ -643,15 +743,17 @@ public:
     {
         return state_info->zobristKey;
     }
-    std::array<uint64_t, 128> getZobristKeysArray() const { return m_zobrist_keys_array; }
+    int getCastlingRights() const { return state_info->castlingRights; }
+    int getReversibleMovesMade() const { return state_info->reversibleMovesMade; }
+    // Square behind a pawn that just moved two squares, 0 otherwise
+    int getPassantSquare() const { return state_info->pSquare; }
+    int getPly() const { return m_ply; }
     void printZobristKeys() const
+    // Keys of the positions back to the last irreversible move, the current one first
     {
-        std::array<uint64_t, 128> keys = getZobristKeysArray();
-        for (size_t i = 0; i < keys.size(); ++i)
-        {
-            if (keys[i] != 0)
-                std::cout << "Key[" << i << "] = " << keys[i] << "\n";
-        }
+        const StateInfo *previous_state{state_info};
+        for (int i = 0; i <= state_info->reversibleMovesMade; ++i, previous_state = previous_state->previous)
+            std::cout << "Key[-" << i << "] = " << previous_state->zobristKey << "\n";
     }
     void print50MoveCount()
     {
@@ -680,7 +782,7 @@ public:
     int getWhiteKingPosition() const { return m_king_position[0]; }
     int getBlackKingPosition() const { return m_king_position[1]; }
 
-    void printBoard(const int board[64], const std::string &label)
+    void printBoard(const uint8_t board[64], const std::string &label)
     {
         std::cout << label << ":\n";
         for (int rank = 7; rank >= 0; --rank) // Start from the top rank (rank 8)
@@ -688,7 +790,7 @@ public:
             for (int file = 0; file < 8; ++file) // Left-to-right within the rank
             {
                 int index = rank * 8 + file;
-                std::cout << board[index] << " ";
+                std::cout << static_cast<int>(board[index]) << " ";
             }
             std::cout << "\n"; // Newline after each rank
         }
@@ -696,8 +798,7 @@ public:
 
     void debugBoardState()
     {
-        printBoard(m_white_board, "White Board");
-        printBoard(m_black_board, "Black Board");
+        printBoard(m_board, "Board");
 
         std::cout << "\nBitboards:\n";
         for (int color = 0; color < 2; ++color)
@@ -757,32 +858,7 @@ public:
             for (int col = 0; col < 8; ++col)
             {
                 int square = row * 8 + col;
-                uint64_t bit = 1ULL << square;
-                char pieceChar = ' ';
-                if (m_pieces[0][0] & bit)
-                    pieceChar = 'P';
-                else if (m_pieces[0][1] & bit)
-                    pieceChar = 'N';
-                else if (m_pieces[0][2] & bit)
-                    pieceChar = 'B';
-                else if (m_pieces[0][3] & bit)
-                    pieceChar = 'R';
-                else if (m_pieces[0][4] & bit)
-                    pieceChar = 'Q';
-                else if (m_pieces[0][5] & bit)
-                    pieceChar = 'K';
-                else if (m_pieces[1][0] & bit)
-                    pieceChar = 'p';
-                else if (m_pieces[1][1] & bit)
-                    pieceChar = 'n';
-                else if (m_pieces[1][2] & bit)
-                    pieceChar = 'b';
-                else if (m_pieces[1][3] & bit)
-                    pieceChar = 'r';
-                else if (m_pieces[1][4] & bit)
-                    pieceChar = 'q';
-                else if (m_pieces[1][5] & bit)
-                    pieceChar = 'k';
+                char pieceChar = "PNBRQKpnbrqk "[m_board[square]];
 
                 if (pieceChar != ' ')
                 {
@@ -829,7 +905,13 @@ public:
 
         // En passant target square
         fen += ' ';
-        fen += '-';
+        if (state_info->pSquare)
+        {
+            fen += static_cast<char>('a' + state_info->pSquare % 8);
+            fen += static_cast<char>('1' + state_info->pSquare / 8);
+        }
+        else
+            fen += '-';
 
         // Halfmove clock and fullmove number placeholders (not stored in BitPosition)
         fen += " 0 1"; // These values would need to be tracked elsewhere for accuracy
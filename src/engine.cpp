@@ -11,20 +11,218 @@
 #include "position_eval.h"
 #include "engine.h"
 #include "move_selectors.h"
-#include <unordered_map>
+#include "history.h"
+#include "syzygy.h"
+#include <cmath>
+#include <atomic>
+#include <iostream>
 
 extern TranspositionTable globalTT;
 extern int OURTIME;
 extern int OURINC;
 extern std::chrono::time_point<std::chrono::high_resolution_clock> STARTTIME;
+extern int REVERSEFUTILITYMARGIN;
+extern int FUTILITYMARGIN;
+extern int LATEMOVEPRUNINGBASE;
+extern int ASPIRATIONWINDOW;
+extern int MULTIPV;
+extern bool PRINTSEARCHINFO;
 
 int DEPTH;
 Move ourMoveMade;
 bool isEndgame;
 
-std::unordered_map<Move, std::vector<int16_t>> moveDepthValues;
+// Root of the current iteration, to bound check extensions
+int8_t rootDepth;
+int rootPly;
 
-bool stopSearch(const std::vector<int16_t> &values, int streak, int depth, BitPosition &position)
+// Best root value at the time each root move was searched, one per iteration (depths are int8_t).
+// Indexed as the root moves were generated, since the root move list is reordered every iteration.
+using DepthValues = FixedList<int16_t, 128>;
+MoveList<MAX_MOVES> rootMoves;
+DepthValues moveDepthValues[MAX_MOVES];
+
+DepthValues &depthValuesOf(Move move)
+{
+    for (int i = 0; i < rootMoves.size(); ++i)
+        if (rootMoves[i] == move)
+            return moveDepthValues[i];
+    // Not a root move (a tt move from another position), which has no values
+    static DepthValues no_values;
+    no_values.clear();
+    return no_values;
+}
+
+// Quiet move ordering tables, one per search thread
+thread_local MoveHistory moveHistory;
+
+// States of the positions made in the search, indexed by ply from the root, one stack per search thread.
+// They are contiguous in memory instead of being spread over the recursion frames.
+// Plies from the root are bounded by the depth (an int8_t), check extensions (twice the root depth) and captures.
+constexpr int MAX_SEARCH_PLY{512};
+alignas(64) thread_local StateInfo searchStates[MAX_SEARCH_PLY];
+
+// Values of tablebase wins and losses, beyond any evaluation (0 to 4096) and short of checkmates.
+// They are symmetric around the draw value, and wins closer to the root (losses further from it) are preferred.
+constexpr int16_t TB_WIN_VALUE{20000};
+constexpr int16_t TB_LOSS_VALUE{64 * 64 - TB_WIN_VALUE};
+
+// Bounds of the values of mates and tablebase results within the search
+constexpr int16_t MATE_IN_MAX_PLY{MATE_VALUE - MAX_SEARCH_PLY};
+constexpr int16_t MATED_IN_MAX_PLY{MATED_VALUE + MAX_SEARCH_PLY};
+constexpr int16_t TB_WIN_IN_MAX_PLY{TB_WIN_VALUE - MAX_SEARCH_PLY};
+constexpr int16_t TB_LOSS_IN_MAX_PLY{TB_LOSS_VALUE + MAX_SEARCH_PLY};
+
+inline bool isMateValue(int16_t value) { return value >= MATE_IN_MAX_PLY || value <= MATED_IN_MAX_PLY; }
+
+// Mate and tablebase values count plies from the root, but the ttable stores them counted from the position
+// so that they stay right when it is reached at another ply
+inline int16_t valueToTT(int16_t value, int ply_from_root)
+{
+    if (value >= TB_WIN_IN_MAX_PLY)
+        return static_cast<int16_t>(value + ply_from_root);
+    if (value <= TB_LOSS_IN_MAX_PLY)
+        return static_cast<int16_t>(value - ply_from_root);
+    return value;
+}
+
+inline int16_t valueFromTT(int16_t value, int ply_from_root)
+{
+    if (value >= TB_WIN_IN_MAX_PLY)
+        return static_cast<int16_t>(value - ply_from_root);
+    if (value <= TB_LOSS_IN_MAX_PLY)
+        return static_cast<int16_t>(value + ply_from_root);
+    return value;
+}
+
+// Search counters reported in the info lines, one set per search thread on its own cache line. Each thread only
+// writes its own counters (relaxed loads and stores, no read-modify-write), and they are summed when reported.
+struct alignas(64) SearchCounters
+{
+    std::atomic<uint64_t> nodes{0};
+    std::atomic<uint64_t> tbHits{0}; // Tablebase probes that found the position
+    std::atomic<int> selDepth{0};    // Deepest ply from the root reached, quiescence search included
+
+    void clear()
+    {
+        nodes.store(0, std::memory_order_relaxed);
+        tbHits.store(0, std::memory_order_relaxed);
+        selDepth.store(0, std::memory_order_relaxed);
+    }
+};
+
+constexpr int MAX_SEARCH_THREADS{64};
+SearchCounters searchCounters[MAX_SEARCH_THREADS];
+thread_local int searchThreadIndex{0};
+
+inline void increment(std::atomic<uint64_t> &counter)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// Counts a node at a ply from the root
+inline void countNode(int ply_from_root)
+{
+    SearchCounters &counters{searchCounters[searchThreadIndex]};
+    increment(counters.nodes);
+    if (ply_from_root > counters.selDepth.load(std::memory_order_relaxed))
+        counters.selDepth.store(ply_from_root, std::memory_order_relaxed);
+}
+
+struct SearchTotals
+{
+    uint64_t nodes{0};
+    uint64_t tbHits{0};
+    int selDepth{0};
+};
+
+SearchTotals totalCounters()
+{
+    SearchTotals total;
+    for (const SearchCounters &counters : searchCounters)
+    {
+        total.nodes += counters.nodes.load(std::memory_order_relaxed);
+        total.tbHits += counters.tbHits.load(std::memory_order_relaxed);
+        total.selDepth = std::max(total.selDepth, counters.selDepth.load(std::memory_order_relaxed));
+    }
+    return total;
+}
+
+uint64_t searchedNodes() { return totalCounters().nodes; }
+
+// Principal variations as a triangular table: the line of the node at a ply from the root is its best move
+// followed by the line of the child, copied whenever a move improves the value inside the window.
+// Lines at a ply have at most MAX_PV_PLY - ply moves, deeper nodes don't keep lines.
+constexpr int MAX_PV_PLY{128};
+struct PvLine
+{
+    int length{0};
+    Move moves[MAX_PV_PLY];
+};
+thread_local PvLine pvLines[MAX_PV_PLY];
+// Lines of the root moves in the last root search, in the order they were searched (for MultiPV)
+thread_local PvLine rootMoveLines[MAX_MOVES];
+thread_local int rootMovesSearched;
+
+inline void clearPv(int ply_from_root)
+{
+    if (ply_from_root < MAX_PV_PLY)
+        pvLines[ply_from_root].length = 0;
+}
+
+inline void updatePv(int ply_from_root, Move move)
+{
+    if (ply_from_root >= MAX_PV_PLY)
+        return;
+    PvLine &line{pvLines[ply_from_root]};
+    line.moves[0] = move;
+    line.length = 1;
+    if (ply_from_root + 1 < MAX_PV_PLY)
+    {
+        const PvLine &child_line{pvLines[ply_from_root + 1]};
+        std::copy(child_line.moves, child_line.moves + child_line.length, line.moves + 1);
+        line.length += child_line.length;
+    }
+}
+
+// Score of a root value in UCI terms. Evaluations (0 to 4096, draws at 2048) are given as centipawns from the draw value,
+// checkmates in moves.
+std::string uciScore(int16_t value)
+{
+    if (value >= MATE_IN_MAX_PLY)
+        return "mate " + std::to_string((MATE_VALUE - value + 1) / 2);
+    if (value <= MATED_IN_MAX_PLY)
+        return "mate -" + std::to_string((value - MATED_VALUE) / 2);
+    return "cp " + std::to_string(value - 2048);
+}
+
+// Value of a tablebase result of the side to move, from the engine's point of view
+int16_t tablebaseValue(syzygy::Wdl wdl, bool our_turn, int ply_from_root)
+{
+    int16_t value{2048}; // Cursed wins and blessed losses are draws under the 50 move rule
+    if (wdl == syzygy::WIN)
+        value = static_cast<int16_t>(TB_WIN_VALUE - ply_from_root);
+    else if (wdl == syzygy::LOSS)
+        value = static_cast<int16_t>(TB_LOSS_VALUE + ply_from_root);
+    return our_turn ? value : static_cast<int16_t>(64 * 64 - value);
+}
+
+// Late move reductions indexed by [depth][number of moves searched]
+int8_t lateMoveReductions[64][64];
+
+void initLateMoveReductions()
+{
+    for (int depth = 0; depth < 64; ++depth)
+        for (int moves = 0; moves < 64; ++moves)
+        {
+            if (depth == 0 || moves == 0)
+                lateMoveReductions[depth][moves] = 0;
+            else
+                lateMoveReductions[depth][moves] = static_cast<int8_t>(0.75 + std::log(depth) * std::log(moves) / 2.25);
+        }
+}
+
+bool stopSearch(const DepthValues &values, int streak, int depth, BitPosition &position)
 {
     // If not endgame
     if (not isEndgame)
@@ -32,7 +230,7 @@ bool stopSearch(const std::vector<int16_t> &values, int streak, int depth, BitPo
         if (streak > 8 && depth > 9)
             return true;
         // Check if the move's score has just increased over time
-        for (std::size_t i = 1; i < values.size(); ++i)
+        for (int i = 1; i < values.size(); ++i)
         {
             if (values[i] <= values[i - 1])
                 return false;
@@ -47,7 +245,7 @@ bool stopSearch(const std::vector<int16_t> &values, int streak, int depth, BitPo
         if (streak > 9 && depth > 10)
             return true;
         // Check if the move's score has just increased over time
-        for (std::size_t i = 1; i < values.size(); ++i)
+        for (int i = 1; i < values.size(); ++i)
         {
             if (values[i] <= values[i - 1])
                 return false;
@@ -62,13 +260,16 @@ bool stopSearch(const std::vector<int16_t> &values, int streak, int depth, BitPo
 int16_t quiesenceSearch(BitPosition &position, int16_t alpha, int16_t beta, bool our_turn)
 // This search is done when depth is less than or equal to 0 and considers only captures and promotions
 {
+    int ply{position.getPly() - rootPly};
+    countNode(ply);
+    clearPv(ply);
+
     // If we are in quiescence, we have a baseline evaluation as if no captures happened
     int16_t value{position.evaluationFunction(our_turn)};
 
     int16_t child_value;
-    Move best_move;
     bool no_captures = true;
-    StateInfo state_info;
+    StateInfo &state_info{searchStates[ply + 1]};
 
     position.setCheckBits();
     if (not position.getIsCheck()) // Not in check
@@ -76,7 +277,8 @@ int16_t quiesenceSearch(BitPosition &position, int16_t alpha, int16_t beta, bool
         bool cutoff{false};
         Move refutation = position.getBestRefutation();
         // Refutation
-        if (refutation.getData() != 0)
+        // Captures losing material in the exchange are not searched
+        if (refutation.getData() != 0 && position.seeGe(refutation))
         {
             position.setBlockersAndPinsInQS();
             if (position.isRefutationLegal(refutation))
@@ -89,7 +291,6 @@ int16_t quiesenceSearch(BitPosition &position, int16_t alpha, int16_t beta, bool
                         if (child_value > value)
                         {
                             value = child_value;
-                            best_move = refutation;
                         }
                         position.unmakeCapture(refutation);
                         if (value >= beta)
@@ -103,7 +304,6 @@ int16_t quiesenceSearch(BitPosition &position, int16_t alpha, int16_t beta, bool
                         if (child_value < value)
                         {
                             value = child_value;
-                            best_move = refutation;
                         }
                         position.unmakeCapture(refutation);
                         if (value <= alpha)
@@ -120,6 +320,8 @@ int16_t quiesenceSearch(BitPosition &position, int16_t alpha, int16_t beta, bool
             move_selector.init();
             while ((capture = move_selector.select_legal()) != Move(0))
             {
+                if (not position.seeGe(capture))
+                    continue;
                 no_captures = false;
                 position.makeCapture(capture, state_info);
                 if (our_turn) // Maximize
@@ -128,7 +330,6 @@ int16_t quiesenceSearch(BitPosition &position, int16_t alpha, int16_t beta, bool
                     if (child_value > value)
                     {
                         value = child_value;
-                        best_move = capture;
                     }
                     position.unmakeCapture(capture);
                     if (value >= beta)
@@ -142,7 +343,6 @@ int16_t quiesenceSearch(BitPosition &position, int16_t alpha, int16_t beta, bool
                     if (child_value < value)
                     {
                         value = child_value;
-                        best_move = capture;
                     }
                     position.unmakeCapture(capture);
                     if (value <= alpha)
@@ -169,7 +369,6 @@ int16_t quiesenceSearch(BitPosition &position, int16_t alpha, int16_t beta, bool
                 if (child_value > value)
                 {
                     value = child_value;
-                    best_move = capture;
                 }
                 position.unmakeCapture(capture);
                 if (value >= beta)
@@ -183,7 +382,6 @@ int16_t quiesenceSearch(BitPosition &position, int16_t alpha, int16_t beta, bool
                 if (child_value < value)
                 {
                     value = child_value;
-                    best_move = capture;
                 }
                 position.unmakeCapture(capture);
                 if (value <= alpha)
@@ -196,38 +394,70 @@ int16_t quiesenceSearch(BitPosition &position, int16_t alpha, int16_t beta, bool
     // If there are no captures we return an eval
     if (no_captures && position.getIsCheck() && position.isMate())
     {
-        if (our_turn)
-        {
-            // Saving a tt value
-            globalTT.save(position.getZobristKey(), 0, 0, Move(0), false);
-            return 0;
-        }
-        else
-        {
-            // Saving a tt value
-            globalTT.save(position.getZobristKey(), 30000, 0, Move(0), false);
-            return 30000;
-        }
+        value = our_turn ? static_cast<int16_t>(MATED_VALUE + ply) : static_cast<int16_t>(MATE_VALUE - ply);
+        return value;
     }
-    // Saving a tt value
-    globalTT.save(position.getZobristKey(), value, 0, best_move, false);
+    // Nothing is saved in the ttable: makeCapture doesn't update the zobrist key, so it isn't this position's
     return value;
 }
 
-int16_t alphaBetaSearch(BitPosition &position, int8_t depth, int16_t alpha, int16_t beta, bool our_turn)
+int16_t alphaBetaSearch(BitPosition &position, int8_t depth, int16_t alpha, int16_t beta, bool our_turn, bool null_move_allowed = true, Move excluded_move = Move(0))
 // This search is done when depth is more than 0 and considers all moves and stores positions in the transposition table
+// null_move_allowed is false right after a null move and inside null move verification searches
+// excluded_move is skipped in singular extension searches, which don't probe or store this position in the ttable
 {
+    int ply{position.getPly() - rootPly};
+    countNode(ply);
+    clearPv(ply);
+
     if (position.isDraw())
         return 2048;
 
+    // If the side to move can go back to an earlier position, it can at least draw
+    if ((our_turn ? alpha < 2048 : beta > 2048) && position.hasUpcomingRepetition(ply))
+    {
+        if (our_turn)
+            alpha = 2048;
+        else
+            beta = 2048;
+        if (alpha >= beta)
+            return 2048;
+    }
+
+    // Mate distance pruning
+    // Nothing from here mates sooner than the next ply or is mated sooner than this one, so a mate found closer
+    // to the root can't be improved on
+    alpha = std::max<int16_t>(alpha, MATED_VALUE + ply);
+    beta = std::min<int16_t>(beta, MATE_VALUE - ply);
+    if (alpha >= beta)
+        return alpha;
+
+    // Positions in the tablebases are not searched. WDL tables can only be probed right after a capture
+    // or pawn move (so mostly once the piece count has just dropped) and without castling rights.
+    if (syzygy::cardinality() > 0 && position.getReversibleMovesMade() == 0 && position.getCastlingRights() == 0 &&
+        syzygy::pieceCount(position) <= syzygy::cardinality())
+    {
+        syzygy::Wdl wdl;
+        if (syzygy::probeWdl(position, wdl))
+        {
+            increment(searchCounters[searchThreadIndex].tbHits);
+            return tablebaseValue(wdl, our_turn, ply);
+        }
+    }
+
+    // Check extension, limited to twice the root depth so that checking sequences can't go on forever
+    if (position.getIsCheck() && ply < 2 * rootDepth)
+        depth++;
+
     bool no_moves{true};
     bool cutoff{false};
+    int moves_searched{0}; // For late move reductions
 
     // Baseline evaluation
     int16_t child_value;
     int16_t value{our_turn ? static_cast<int16_t>(-31000) : static_cast<int16_t>(31000)};
     Move best_move;
-    StateInfo state_info;
+    StateInfo &state_info{searchStates[ply + 1]};
 
     // At depths <= 0 we enter quiesence search
     if (depth <= 0)
@@ -239,68 +469,163 @@ int16_t alphaBetaSearch(BitPosition &position, int8_t depth, int16_t alpha, int1
     position.setBlockersAndPinsInAB(); // For discovered checks and move generators
     position.setCheckBits(); // For direct checks
 
+    bool is_singular_search{excluded_move.getData() != 0};
+
     // Check if we have stored this position in ttable
-    TTEntry *ttEntry = globalTT.probe(position.getZobristKey());
-    Move tt_move{0};
+    TTEntry *ttEntry = is_singular_search ? nullptr : globalTT.probe(position.getZobristKey());
+    Move tt_move{excluded_move};
     bool is_pv_node{false};
     // If position is stored in ttable
     if (ttEntry != nullptr)
     {
+        tt_move = ttEntry->getMove();
         // We are in a PV-Node
-        if (ttEntry->getIsExact())
+        is_pv_node = ttEntry->getIsExact();
+        // At a deeper depth the value is returned if its bound decides the window, otherwise it narrows it
+        if (ttEntry->getDepth() >= depth)
         {
-            if (ttEntry->getDepth() >= depth)
-                return ttEntry->getValue();
-                
-            is_pv_node = true;
-            tt_move = ttEntry->getMove();
+            int16_t tt_value{valueFromTT(ttEntry->getValue(), ply)};
+            if (ttEntry->getIsExact())
+                return tt_value;
+            if (ttEntry->getBound() == BOUND_LOWER)
+                alpha = std::max(alpha, tt_value);
+            else if (ttEntry->getBound() == BOUND_UPPER)
+                beta = std::min(beta, tt_value);
+            if (alpha >= beta)
+                return tt_value;
         }
-        // We are not in a PV-Node
-        else
+    }
+    // Window of this search, the value saved in the ttable is a bound if it falls outside
+    int16_t search_alpha{alpha};
+    int16_t search_beta{beta};
+
+    // Internal iterative reductions
+    // Without a ttable move at high depth the ordering is poor, so a shallower search is cheaper and fills the ttable
+    if (tt_move.getData() == 0 && depth >= 5)
+        depth--;
+
+    // Static evaluation for pruning decisions (not used in check, in PV nodes or in singular extension searches)
+    bool can_prune{not is_pv_node && not position.getIsCheck() && not is_singular_search};
+    int16_t static_eval{can_prune ? position.evaluationFunction(our_turn) : static_cast<int16_t>(2048)};
+
+    // Reverse futility pruning
+    // Near the horizon, if the static eval is far beyond the bound we assume a move will keep it there.
+    if (can_prune && depth >= 2 && depth <= 3)
+    {
+        if (our_turn && beta < MATE_IN_MAX_PLY && static_eval - REVERSEFUTILITYMARGIN * depth >= beta)
+            return static_eval;
+        if (not our_turn && alpha > MATED_IN_MAX_PLY && static_eval + REVERSEFUTILITYMARGIN * depth <= alpha)
+            return static_eval;
+    }
+
+    // Null move pruning
+    // If passing the turn still fails high (low for the opponent), a real move will most likely do so too.
+    // Not done in check, in PV nodes or in endgames (where zugzwang positions are common).
+    if (null_move_allowed && depth >= 3 && can_prune && not position.isEndgame())
+    {
+        int8_t reduction = 2 + depth / 4;
+        if (our_turn && static_eval >= beta)
         {
-            tt_move = ttEntry->getMove();
-            if (ttEntry->getDepth() >= depth)
+            position.makeNullMove(state_info);
+            child_value = alphaBetaSearch(position, depth - 1 - reduction, beta - 1, beta, false, false);
+            position.unmakeNullMove();
+            if (child_value >= beta)
+            {
+                // At high depths we verify the cutoff with a reduced search without null moves
+                if (depth < 8 || alphaBetaSearch(position, depth - reduction, beta - 1, beta, true, false) >= beta)
+                    return beta;
+            }
+        }
+        else if (not our_turn && static_eval <= alpha)
+        {
+            position.makeNullMove(state_info);
+            child_value = alphaBetaSearch(position, depth - 1 - reduction, alpha, alpha + 1, true, false);
+            position.unmakeNullMove();
+            if (child_value <= alpha)
             {
-                // Lower bound at deeper depth
-                if (our_turn)
-                    alpha = ttEntry->getValue();
-                // Upper bound at deeper depth
-                else
-                    beta = ttEntry->getValue();
+                if (depth < 8 || alphaBetaSearch(position, depth - reduction, alpha, alpha + 1, false, false) <= alpha)
+                    return alpha;
             }
         }
     }
 
+    // Null move verification searches used this ply's line
+    clearPv(ply);
+
     // Transposition table move search
-    if (tt_move.getData() != 0 && position.ttMoveIsOk(tt_move))
+    if (not is_singular_search && tt_move.getData() != 0 && position.ttMoveIsOk(tt_move))
     {
         no_moves = false;
+        moves_searched++;
+
+        // Singular extension
+        // If every other move fails well below the ttable value at reduced depth, the ttable move is the only good one and we extend it.
+        // Limited to twice the root depth like the check extension, so that extensions can't keep the depth from decreasing.
+        int8_t extension{0};
+        if (depth >= 6 && ply < 2 * rootDepth && not position.getIsCheck() && ttEntry->getDepth() >= depth - 3 && not isMateValue(ttEntry->getValue()) &&
+            (ttEntry->getBound() & (our_turn ? BOUND_LOWER : BOUND_UPPER)))
+        {
+            int16_t tt_value{valueFromTT(ttEntry->getValue(), ply)};
+            if (our_turn)
+            {
+                int16_t singular_beta{static_cast<int16_t>(tt_value - 5 * depth)};
+                child_value = alphaBetaSearch(position, (depth - 1) / 2, singular_beta - 1, singular_beta, true, false, tt_move);
+                if (child_value < singular_beta)
+                    extension = 1;
+                // Multi-cut: another move also beats beta, so this node most likely fails high
+                else if (singular_beta >= beta)
+                    return singular_beta;
+            }
+            else
+            {
+                int16_t singular_alpha{static_cast<int16_t>(tt_value + 5 * depth)};
+                child_value = alphaBetaSearch(position, (depth - 1) / 2, singular_alpha, singular_alpha + 1, false, false, tt_move);
+                if (child_value > singular_alpha)
+                    extension = 1;
+                else if (singular_alpha <= alpha)
+                    return singular_alpha;
+            }
+            // So did the singular search
+            clearPv(ply);
+        }
 
         if (our_turn) // Maximize
         {
             position.makeMove(tt_move, state_info);
-            child_value = alphaBetaSearch(position, depth - 1, alpha, beta, false);
+            child_value = alphaBetaSearch(position, depth - 1 + extension, alpha, beta, false);
             position.unmakeMove(tt_move);
             if (child_value > value)
             {
                 value = child_value;
                 best_move = tt_move;
+                if (value > alpha)
+                    updatePv(ply, tt_move);
                 if (value >= beta)
+                {
                     cutoff = true;
+                    if (position.isQuiet(tt_move))
+                        moveHistory.updateQuiet(position.getTurn(), depth, tt_move, position.movingPiece(tt_move), position.previousPiece(), position.previousDestination(), nullptr, nullptr, 0);
+                }
             }
             alpha = std::max(alpha, value);
         }
         else // Minimize
         {
             position.makeMove(tt_move, state_info);
-            child_value = alphaBetaSearch(position, depth - 1, alpha, beta, true);
+            child_value = alphaBetaSearch(position, depth - 1 + extension, alpha, beta, true);
             position.unmakeMove(tt_move);
             if (child_value < value)
             {
                 value = child_value;
                 best_move = tt_move;
+                if (value < beta)
+                    updatePv(ply, tt_move);
                 if (value <= alpha)
+                {
                     cutoff = true;
+                    if (position.isQuiet(tt_move))
+                        moveHistory.updateQuiet(position.getTurn(), depth, tt_move, position.movingPiece(tt_move), position.previousPiece(), position.previousDestination(), nullptr, nullptr, 0);
+                }
             }
             beta = std::min(beta, value);
         }
@@ -311,178 +636,103 @@ int16_t alphaBetaSearch(BitPosition &position, int8_t depth, int16_t alpha, int1
     {
         if (not position.getIsCheck()) // Not in check
         {
-            if (false) // PV Nodes usually produce cutoffs so we generate moves by parts
+            Move move;
+            ABMoveSelectorNotCheck move_selector(position, tt_move, &moveHistory);
+            // Quiet moves searched before a cutoff get a history malus
+            Move quiets_searched[64];
+            int quiet_pieces[64];
+            int quiets_count{0};
+            while ((move = move_selector.next_move()) != Move(0))
             {
-                Move move;
-                ABMoveSelectorNotCheck move_selector(position, tt_move);
-                move_selector.init_refutations();
-                while ((move = move_selector.select_legal()) != Move(0))
+                no_moves = false;
+                moves_searched++;
+                bool quiet_move{position.isQuiet(move)};
+                int moved_piece{position.movingPiece(move)};
+                int history_score{quiet_move ? moveHistory.quietScore(position.getTurn(), move, moved_piece, position.previousPiece(), position.previousDestination()) : 0};
+                // Quiet moves that don't give check can be pruned or reduced
+                bool is_quiet{quiet_move && not position.givesCheck(move)};
+
+                // Shallow depth pruning of quiet moves, decided before making them
+                // Futility pruning: the static eval is so far behind the bound that a quiet move won't catch up.
+                // Late move pruning: after enough moves at low depth, the remaining quiet moves are unlikely to matter.
+                if (can_prune && is_quiet && depth <= 3 && moves_searched > 1)
                 {
-                    no_moves = false;
-                    if (our_turn) // Maximize
-                    {
-                        position.makeMove(move, state_info);
-                        child_value = alphaBetaSearch(position, depth - 1, alpha, beta, false);
-                        position.unmakeMove(move);
-                        if (child_value > value)
-                        {
-                            value = child_value;
-                            best_move = move;
-                            if (value >= beta)
-                            {
-                                cutoff = true;
-                                break;
-                            }
-                        }
-                        alpha = std::max(alpha, value);
-                    }
-                    else // Minimize
+                    int16_t futility_value{static_cast<int16_t>(our_turn ? static_eval + FUTILITYMARGIN * depth : static_eval - FUTILITYMARGIN * depth)};
+                    bool futile{our_turn ? (futility_value <= alpha && alpha < MATE_IN_MAX_PLY) : (futility_value >= beta && beta > MATED_IN_MAX_PLY)};
+                    if (futile || moves_searched > LATEMOVEPRUNINGBASE + depth * depth)
                     {
-                        position.makeMove(move, state_info);
-                        child_value = alphaBetaSearch(position, depth - 1, alpha, beta, true);
-                        position.unmakeMove(move);
-                        if (child_value < value)
-                        {
-                            value = child_value;
-                            best_move = move;
-                            if (value <= alpha)
-                            {
-                                cutoff = true;
-                                break;
-                            }
-                        }
-                        beta = std::min(beta, value);
+                        if (futile)
+                            value = our_turn ? std::max(value, futility_value) : std::min(value, futility_value);
+                        continue;
                     }
                 }
-                if (not cutoff)
+
+                position.makeMove(move, state_info);
+
+                // Late move reductions
+                // Quiet moves that don't give check and come late in the ordering are searched at a reduced depth first
+                int8_t reduction = 0;
+                if (depth >= 3 && moves_searched > 3 && is_quiet)
                 {
-                    move_selector.init_good_captures();
-                    while ((move = move_selector.select_legal()) != Move(0))
-                    {
-                        no_moves = false;
-                        if (our_turn) // Maximize
-                        {
-                            position.makeMove(move, state_info);
-                            child_value = alphaBetaSearch(position, depth - 1, alpha, beta, false);
-                            position.unmakeMove(move);
-                            if (child_value > value)
-                            {
-                                value = child_value;
-                                best_move = move;
-                                if (value >= beta)
-                                {
-                                    cutoff = true;
-                                    break;
-                                }
-                            }
-
-                            alpha = std::max(alpha, value);
-                        }
-                        else // Minimize
-                        {
-                            position.makeMove(move, state_info);
-                            child_value = alphaBetaSearch(position, depth - 1, alpha, beta, true);
-                            position.unmakeMove(move);
-                            if (child_value < value)
-                            {
-                                value = child_value;
-                                best_move = move;
-                                if (value <= alpha)
-                                {
-                                    cutoff = true;
-                                    break;
-                                }
-                            }
-                            beta = std::min(beta, value);
-                        }
-                    }
+                    reduction = lateMoveReductions[std::min<int>(depth, 63)][std::min(moves_searched, 63)];
+                    if (is_pv_node && reduction > 0)
+                        reduction--;
+                    // Moves with a good history are reduced less and those with a bad one more
+                    reduction -= std::clamp(history_score / (MAX_HISTORY / 2), -2, 2);
+                    // Never drop straight into quiescence search
+                    reduction = std::clamp<int8_t>(reduction, 0, depth - 2);
                 }
-                if (not cutoff)
+
+                if (our_turn) // Maximize
                 {
-                    move_selector.init_rest();
-                    while ((move = move_selector.select_legal()) != Move(0))
+                    child_value = alphaBetaSearch(position, depth - 1 - reduction, alpha, beta, false);
+                    // If the reduced search beats alpha we re-search at full depth
+                    if (reduction > 0 && child_value > alpha)
+                        child_value = alphaBetaSearch(position, depth - 1, alpha, beta, false);
+                    position.unmakeMove(move);
+                    if (child_value > value)
                     {
-                        no_moves = false;
-                        if (our_turn) // Maximize
-                        {
-                            position.makeMove(move, state_info);
-                            child_value = alphaBetaSearch(position, depth - 1, alpha, beta, false);
-                            position.unmakeMove(move);
-                            if (child_value > value)
-                            {
-                                value = child_value;
-                                best_move = move;
-                                if (value >= beta)
-                                {
-                                    cutoff = true;
-                                    break;
-                                }
-                            }
-                            alpha = std::max(alpha, value);
-                        }
-                        else // Minimize
+                        value = child_value;
+                        best_move = move;
+                        if (value > alpha)
+                            updatePv(ply, move);
+                        if (value >= beta)
                         {
-                            position.makeMove(move, state_info);
-                            child_value = alphaBetaSearch(position, depth - 1, alpha, beta, true);
-                            position.unmakeMove(move);
-                            if (child_value < value)
-                            {
-                                value = child_value;
-                                best_move = move;
-                                if (value <= alpha)
-                                {
-                                    cutoff = true;
-                                    break;
-                                }
-                            }
-
-                            beta = std::min(beta, value);
+                            cutoff = true;
+                            if (quiet_move)
+                                moveHistory.updateQuiet(position.getTurn(), depth, move, moved_piece, position.previousPiece(), position.previousDestination(), quiets_searched, quiet_pieces, quiets_count);
+                            break;
                         }
                     }
+                    alpha = std::max(alpha, value);
                 }
-            }
-            else // Non PV nodes
-            {
-                Move move;
-                ABMoveSelectorNotCheck move_selector(position, tt_move);
-                move_selector.init_all();
-                while ((move = move_selector.select_legal()) != Move(0))
+                else // Minimize
                 {
-                    no_moves = false;
-                    if (our_turn) // Maximize
-                    {
-                        position.makeMove(move, state_info);
-                        child_value = alphaBetaSearch(position, depth - 1, alpha, beta, false);
-                        position.unmakeMove(move);
-                        if (child_value > value)
-                        {
-                            value = child_value;
-                            best_move = move;
-                            if (value >= beta)
-                            {
-                                cutoff = true;
-                                break;
-                            }
-                        }
-                        alpha = std::max(alpha, value);
-                    }
-                    else // Minimize
-                    {
-                        position.makeMove(move, state_info);
+                    child_value = alphaBetaSearch(position, depth - 1 - reduction, alpha, beta, true);
+                    // If the reduced search beats beta we re-search at full depth
+                    if (reduction > 0 && child_value < beta)
                         child_value = alphaBetaSearch(position, depth - 1, alpha, beta, true);
-                        position.unmakeMove(move);
-                        if (child_value < value)
+                    position.unmakeMove(move);
+                    if (child_value < value)
+                    {
+                        value = child_value;
+                        best_move = move;
+                        if (value < beta)
+                            updatePv(ply, move);
+                        if (value <= alpha)
                         {
-                            value = child_value;
-                            best_move = move;
-                            if (value <= alpha)
-                            {
-                                cutoff = true;
-                                break;
-                            }
+                            cutoff = true;
+                            if (quiet_move)
+                                moveHistory.updateQuiet(position.getTurn(), depth, move, moved_piece, position.previousPiece(), position.previousDestination(), quiets_searched, quiet_pieces, quiets_count);
+                            break;
                         }
-                        beta = std::min(beta, value);
                     }
+                    beta = std::min(beta, value);
+                }
+                if (quiet_move && quiets_count < 64)
+                {
+                    quiets_searched[quiets_count] = move;
+                    quiet_pieces[quiets_count++] = moved_piece;
                 }
             }
         }
@@ -504,6 +754,8 @@ int16_t alphaBetaSearch(BitPosition &position, int8_t depth, int16_t alpha, int1
                     {
                         value = child_value;
                         best_move = move;
+                        if (value > alpha)
+                            updatePv(ply, move);
                         if (value >= beta)
                         {
                             cutoff = true;
@@ -521,6 +773,8 @@ int16_t alphaBetaSearch(BitPosition &position, int8_t depth, int16_t alpha, int1
                     {
                         value = child_value;
                         best_move = move;
+                        if (value < beta)
+                            updatePv(ply, move);
                         if (value <= alpha)
                         {
                             cutoff = true;
@@ -532,39 +786,50 @@ int16_t alphaBetaSearch(BitPosition &position, int8_t depth, int16_t alpha, int1
             }
         }
     }
+    // Singular extension searches only need the value of the other moves
+    if (is_singular_search)
+        return value;
+
     // Game finished since there are no legal moves
     if (no_moves)
     {
         // Stalemate
         if (not position.getIsCheck())
         {
-            globalTT.save(position.getZobristKey(), 2048, depth, best_move, true);
+            globalTT.save(position.getZobristKey(), 2048, depth, best_move, BOUND_EXACT);
             value = 2048;
         }
         // Checkmate against us
         else if (our_turn)
         {
-            globalTT.save(position.getZobristKey(), 0, depth, best_move, true);
-            return - depth;
+            globalTT.save(position.getZobristKey(), MATED_VALUE, depth, best_move, BOUND_EXACT);
+            return static_cast<int16_t>(MATED_VALUE + ply);
         }
         // Checkmate against opponent
         else
         {
-            globalTT.save(position.getZobristKey(), 30000, depth, best_move, true);
-            return 30000 + depth;
+            globalTT.save(position.getZobristKey(), MATE_VALUE, depth, best_move, BOUND_EXACT);
+            return static_cast<int16_t>(MATE_VALUE - ply);
         }
     }
     // Saving a tt value
-    globalTT.save(position.getZobristKey(), value, depth, best_move, not cutoff);
+    Bound bound{value >= search_beta ? BOUND_LOWER : value <= search_alpha ? BOUND_UPPER : BOUND_EXACT};
+    globalTT.save(position.getZobristKey(), valueToTT(value, ply), depth, best_move, bound);
 
     return value;
 }
 
-std::tuple<Move, int16_t, std::vector<int16_t>> firstMoveSearch(BitPosition &position, int8_t depth, int16_t alpha, int16_t beta, std::vector<Move> &first_moves, std::vector<int16_t> &first_moves_scores, std::chrono::milliseconds timeForMoveMS, std::chrono::milliseconds predictedTimeTakenMs, int &lastFirstMoveTimeTakenMS)
+std::pair<Move, int16_t> firstMoveSearch(BitPosition &position, int8_t depth, int16_t alpha, int16_t beta, MoveList<MAX_MOVES> &first_moves, FixedList<int16_t, MAX_MOVES> &first_moves_scores, std::chrono::milliseconds timeForMoveMS, std::chrono::milliseconds predictedTimeTakenMs, int &lastFirstMoveTimeTakenMS)
 // This search is done when depth is more than 0 and considers all moves
 // Note that here we have no alpha/beta cutoffs, since we are only applying the first move.
+// first_moves and first_moves_scores are reordered in place and the scores updated with this search.
 {
-    // Try transposition table first
+    rootDepth = depth;
+    rootPly = position.getPly();
+    clearPv(0);
+
+    // Try transposition table first. With several lines every root move is searched, so only its move is used.
+    bool multi_pv{MULTIPV > 1};
     TTEntry *ttEntry = globalTT.probe(position.getZobristKey());
     Move tt_move;
 
@@ -576,33 +841,31 @@ std::tuple<Move, int16_t, std::vector<int16_t>> firstMoveSearch(BitPosition &pos
             tt_move = ttEntry->getMove();
         // If depth in ttable is higher or equal than the one we are going to search:
         // 1) Exact value, we just return it
-        else if (ttEntry->getDepth() >= depth && ttEntry->getIsExact())
-            return std::tuple<Move, int16_t, std::vector<int16_t>>(ttEntry->getMove(), ttEntry->getValue(), first_moves_scores);
-        // 2) Lower bound at deeper depth and best move found
+        else if (ttEntry->getDepth() >= depth && ttEntry->getIsExact() && not multi_pv)
+            return std::pair<Move, int16_t>(ttEntry->getMove(), ttEntry->getValue());
+        // 2) Lower bound at deeper depth and best move found (upper bounds only give the move)
         else if (ttEntry->getDepth() >= depth)
         {
             tt_move = ttEntry->getMove();
-            alpha = ttEntry->getValue();
+            if (ttEntry->getBound() == BOUND_LOWER && ttEntry->getValue() < beta && not multi_pv)
+                alpha = std::max(alpha, ttEntry->getValue());
         }
     }
 
     // Reorder the first moves by last-known scores or first-time ordering
     if (first_moves_scores.empty())
     {
-        first_moves = position.orderAllMovesOnFirstIterationFirstTime(first_moves, tt_move);
+        position.orderAllMovesOnFirstIterationFirstTime(first_moves, tt_move);
         first_moves_scores.resize(first_moves.size(), -30001);
     }
     else
-    {
-        std::pair<std::vector<Move>, std::vector<int16_t>> result =
-            position.orderAllMovesOnFirstIteration(first_moves, first_moves_scores);
-        first_moves = result.first;
-        first_moves_scores = result.second;
-    }
+        position.orderAllMovesOnFirstIteration(first_moves, first_moves_scores);
 
     // Baseline initialization
+    int16_t original_alpha{alpha};
     int16_t value = static_cast<int16_t>(-30001);
     Move best_move{0};
+    int best_index{-1};
 
     // Keep track of best previous iteration score to decide “penalty”
     // (If a move’s prior score is way below this, we reduce the depth.)
@@ -612,13 +875,14 @@ std::tuple<Move, int16_t, std::vector<int16_t>> firstMoveSearch(BitPosition &pos
             bestScoreFromPreviousIteration = sc;
 
     auto first_move_start_time = std::chrono::high_resolution_clock::now();
+    rootMovesSearched = 0;
 
     // Main loop over candidate moves
-    for (std::size_t i = 0; i < first_moves.size(); ++i)
+    for (int i = 0; i < first_moves.size(); ++i)
     {
         Move currentMove = first_moves[i];
 
-        StateInfo state_info;
+        StateInfo &state_info{searchStates[1]};
         position.makeMove(currentMove, state_info);
 
         // ----------------------------
@@ -656,21 +920,53 @@ std::tuple<Move, int16_t, std::vector<int16_t>> firstMoveSearch(BitPosition &pos
         // Update the move’s new score
         first_moves_scores[i] = child_value;
 
+        rootMovesSearched = i + 1;
+
+        // The line of the move is only known when its value beat the bound
+        if (child_value > alpha)
+        {
+            updatePv(0, currentMove);
+            rootMoveLines[i] = pvLines[0];
+        }
+        else
+        {
+            rootMoveLines[i].moves[0] = currentMove;
+            rootMoveLines[i].length = 1;
+        }
+
         // Track if this is the best so far
         if (child_value > value)
         {
             value = child_value;
             best_move = currentMove;
+            best_index = i;
         }
 
         // Undo the move
         position.unmakeMove(currentMove);
 
-        // Update alpha
-        alpha = std::max(alpha, value);
+        // Update alpha. With several lines the bound is the value of the last of them (the moves searched so far
+        // fill them first), so the values of the best MULTIPV moves are exact and the rest are upper bounds.
+        if (multi_pv)
+        {
+            if (i + 1 >= MULTIPV)
+            {
+                FixedList<int16_t, MAX_MOVES> best_values;
+                for (int j = 0; j <= i; ++j)
+                    best_values.push_back(first_moves_scores[j]);
+                std::nth_element(best_values.begin(), best_values.begin() + (MULTIPV - 1), best_values.end(), std::greater<int16_t>());
+                alpha = std::max(original_alpha, best_values[MULTIPV - 1]);
+            }
+        }
+        else
+            alpha = std::max(alpha, value);
 
         // Store the move’s score in your debugging structure
-        moveDepthValues[currentMove].emplace_back(value);
+        depthValuesOf(currentMove).push_back(value);
+
+        // Fail high on an aspiration window, the caller will widen it and search again
+        if (value >= beta)
+            break;
 
         // Check time
         auto duration = std::chrono::high_resolution_clock::now() - STARTTIME;
@@ -685,18 +981,81 @@ std::tuple<Move, int16_t, std::vector<int16_t>> firstMoveSearch(BitPosition &pos
                                        .count()) +
                                1;
 
-    // Save in TT as “exact”
-    globalTT.save(position.getZobristKey(), value, depth, best_move, true);
+    // The root line is the best move's
+    if (best_index >= 0)
+        pvLines[0] = rootMoveLines[best_index];
+
+    // Save in TT as “exact”, or as a lower bound on an aspiration fail high (fail lows are upper bounds and not stored)
+    if (value > original_alpha)
+        globalTT.save(position.getZobristKey(), value, depth, best_move, value < beta ? BOUND_EXACT : BOUND_LOWER);
+
+    return std::pair<Move, int16_t>(best_move, value);
+}
+
+bool isLegalMove(BitPosition &position, Move move)
+{
+    MoveList<MAX_MOVES> moves{position.getIsCheck() ? position.inCheckAllMoves() : position.allMoves()};
+    for (Move legal_move : moves)
+        if (legal_move == move)
+            return true;
+    return false;
+}
+
+PvLine extendPvFromTT(BitPosition &position, PvLine line)
+// A ttable value (exact, or a bound deciding the window) ends the search of a node without a line, so the line stops
+// there. It is continued with the ttable moves that follow it, while they are legal and the position doesn't repeat.
+{
+    StateInfo states[MAX_PV_PLY];
+    int moves_made{0};
+    while (moves_made < MAX_PV_PLY)
+    {
+        Move move{line.moves[moves_made]};
+        if (moves_made >= line.length)
+        {
+            TTEntry *ttEntry{position.isDraw() ? nullptr : globalTT.probe(position.getZobristKey())};
+            if (ttEntry == nullptr)
+                break;
+            move = ttEntry->getMove();
+        }
+        if (move.getData() == 0 || not isLegalMove(position, move))
+            break;
+        position.makeMove(move, states[moves_made]);
+        line.moves[moves_made++] = move;
+    }
+    line.length = moves_made;
+    for (int i = moves_made - 1; i >= 0; --i)
+        position.unmakeMove(line.moves[i]);
+    return line;
+}
+
+// Info line of a finished iteration, with the counters of all search threads.
+// multi_pv is the rank of the line when several are reported, 0 otherwise.
+void printSearchInfo(BitPosition &position, int depth, int16_t value, const PvLine &search_line, int multi_pv = 0)
+{
+    if (not PRINTSEARCHINFO)
+        return;
+    PvLine line{extendPvFromTT(position, search_line)};
+    SearchTotals totals{totalCounters()};
+    long long time_ms{std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - STARTTIME).count()};
 
-    return std::tuple<Move, int16_t, std::vector<int16_t>>(best_move, value, first_moves_scores);
+    std::cout << "info depth " << depth << " seldepth " << std::max(depth, totals.selDepth);
+    if (multi_pv > 0)
+        std::cout << " multipv " << multi_pv;
+    std::cout << " score " << uciScore(value) << " nodes " << totals.nodes
+              << " nps " << totals.nodes * 1000 / std::max<long long>(time_ms, 1) << " hashfull " << globalTT.hashfull()
+              << " tbhits " << totals.tbHits << " time " << time_ms << " pv";
+    for (int i = 0; i < line.length; ++i)
+        std::cout << " " << line.moves[i].toString();
+    std::cout << "\n" << std::flush;
 }
 
 std::pair<Move, int16_t> iterativeSearch(BitPosition position, int8_t start_depth, int8_t fixed_max_depth)
 {
     position.initializeNNUEInput();
     isEndgame = position.isEndgame();
-    moveDepthValues = {};
-    std::vector<Move> first_moves;
+    moveHistory.clear();
+    searchCounters[searchThreadIndex].clear();
+    MoveList<MAX_MOVES> first_moves;
     int lastFirstMoveTimeTakenMS {1};
     std::chrono::milliseconds timeForMoveMS{OURTIME / 6};
 
@@ -704,16 +1063,36 @@ std::pair<Move, int16_t> iterativeSearch(BitPosition position, int8_t start_dept
         first_moves = position.inCheckAllMoves();
     else
         first_moves = position.allMoves();
+    rootMoves = first_moves;
+    for (int i = 0; i < rootMoves.size(); ++i)
+        moveDepthValues[i].clear();
+
+    // Without moves the game is over, there is nothing to search
+    if (first_moves.size() == 0)
+        return std::pair<Move, int16_t>(Move(0), position.getIsCheck() ? MATED_VALUE : static_cast<int16_t>(2048));
 
     // If there is only one move in the position, we make it
     if (first_moves.size() == 1) 
         return std::pair<Move, int16_t>(first_moves[0], 0);
 
+    // Tablebase positions are played instantly, with a move keeping the result that makes progress under the 50 move rule
+    if (syzygy::cardinality() > 0 && syzygy::pieceCount(position) <= syzygy::cardinality())
+    {
+        Move tb_move;
+        syzygy::Wdl wdl;
+        if (syzygy::probeRoot(position, tb_move, wdl))
+        {
+            std::cout << "info depth 0 tbhits 1 pv " << tb_move.toString() << "\n" << std::flush;
+            return std::pair<Move, int16_t>(tb_move, tablebaseValue(wdl, true, 0));
+        }
+    }
+
     Move bestMove{};
+    PvLine bestLine; // Principal variation of the last finished iteration
     Move bestMovePreviousDepth{};
-    int16_t bestValue;
-    std::tuple<Move, int16_t, std::vector<int16_t>> tuple;
-    std::vector<int16_t> first_moves_scores; // For first move ordering
+    int16_t bestValue{0};
+    std::pair<Move, int16_t> result;
+    FixedList<int16_t, MAX_MOVES> first_moves_scores; // For first move ordering
     int streak = 1;                          // To keep track of the improvement streak
 
     // Iterative deepening
@@ -733,14 +1112,96 @@ std::pair<Move, int16_t> iterativeSearch(BitPosition position, int8_t start_dept
         int16_t alpha{-31001};
         int16_t beta{31001};
 
-        // Search
-        tuple = firstMoveSearch(position, depth, alpha, beta, first_moves, first_moves_scores, timeForMoveMS, predictedTimeTakenMs, lastFirstMoveTimeTakenMS);
-        bestMove = std::get<0>(tuple);
-        bestValue = std::get<1>(tuple);
-        first_moves_scores = std::get<2>(tuple);
+        // Aspiration window around the previous iteration's score (not used near mate scores, nor with several lines,
+        // whose bound is the value of the last line)
+        int delta{ASPIRATIONWINDOW};
+        if (depth > start_depth and not isMateValue(bestValue) and MULTIPV == 1)
+        {
+            alpha = static_cast<int16_t>(bestValue - delta);
+            beta = static_cast<int16_t>(bestValue + delta);
+        }
+
+        // Search, widening the window exponentially on fail low / fail high
+        while (true)
+        {
+            // A failed search leaves bounds as root scores, so we keep the previous ordering for the re-search
+            MoveList<MAX_MOVES> previous_first_moves{first_moves};
+            FixedList<int16_t, MAX_MOVES> previous_first_moves_scores{first_moves_scores};
+            // A search only appends depth values, so they are restored by their sizes
+            int previous_depth_values_sizes[MAX_MOVES];
+            for (int i = 0; i < rootMoves.size(); ++i)
+                previous_depth_values_sizes[i] = moveDepthValues[i].size();
+
+            result = firstMoveSearch(position, depth, alpha, beta, first_moves, first_moves_scores, timeForMoveMS, predictedTimeTakenMs, lastFirstMoveTimeTakenMS);
+            int16_t value{result.second};
+
+            bool fail_low{value <= alpha and alpha > -31001};
+            bool fail_high{value >= beta and beta < 31001};
+            bool out_of_time{std::chrono::high_resolution_clock::now() - STARTTIME >= timeForMoveMS};
+
+            if ((not fail_low and not fail_high) or (fail_high and out_of_time))
+            {
+                bestMove = result.first;
+                bestValue = value;
+                // Exact ttable values at the root and interrupted searches may leave no line for the move
+                bestLine = pvLines[0];
+                if (bestLine.length == 0 || bestLine.moves[0] != bestMove)
+                {
+                    bestLine.moves[0] = bestMove;
+                    bestLine.length = 1;
+                }
+                break;
+            }
+
+            // On fail low with no time left we keep the previous iteration's move
+            if (out_of_time)
+                break;
+
+            first_moves = previous_first_moves;
+            first_moves_scores = previous_first_moves_scores;
+            for (int i = 0; i < rootMoves.size(); ++i)
+                moveDepthValues[i].resize(previous_depth_values_sizes[i], 0);
+
+            delta *= 2;
+            if (fail_low)
+                alpha = static_cast<int16_t>(std::max(value - delta, -31001));
+            else
+            {
+                beta = static_cast<int16_t>(std::min(value + delta, 31001));
+                // The move that failed high is tried first in the re-search
+                Move fail_high_move{result.first};
+                for (int i = 0; i < first_moves.size(); ++i)
+                    if (first_moves[i].getData() == fail_high_move.getData())
+                        first_moves_scores[i] = value;
+            }
+            // After a few failures we fall back to the full window
+            if (delta > 16 * ASPIRATIONWINDOW)
+            {
+                alpha = -31001;
+                beta = 31001;
+            }
+        }
 
         DEPTH = static_cast<int>(depth);
+        if (MULTIPV == 1)
+            printSearchInfo(position, depth, bestValue, bestLine);
+        else
+        {
+            // Best lines of the root moves searched in this iteration
+            int lines[MAX_MOVES];
+            for (int i = 0; i < rootMovesSearched; ++i)
+                lines[i] = i;
+            int lines_count{std::min(MULTIPV, rootMovesSearched)};
+            std::partial_sort(lines, lines + lines_count, lines + rootMovesSearched,
+                              [&](int a, int b) { return first_moves_scores[a] > first_moves_scores[b]; });
+            for (int i = 0; i < lines_count; ++i)
+                printSearchInfo(position, depth, first_moves_scores[lines[i]], rootMoveLines[lines[i]], i + 1);
+        }
         
+        // A mate within the depth searched won't get shorter, deeper searches would only waste time
+        if (bestValue >= MATE_IN_MAX_PLY && MATE_VALUE - bestValue <= depth && MULTIPV == 1)
+            break;
+
         if (bestMove.getData() == bestMovePreviousDepth.getData())
             streak++;
         else
@@ -749,7 +1210,7 @@ std::pair<Move, int16_t> iterativeSearch(BitPosition position, int8_t start_dept
             streak = 1;
         }
         // Check stop condition based on streak and improvement pattern
-        if (stopSearch(moveDepthValues[bestMove], streak, depth, position))
+        if (stopSearch(depthValuesOf(bestMove), streak, depth, position))
         {
             break;
         }
@@ -17,6 +17,22 @@ extern TranspositionTable globalTT;
 extern int OURTIME;
 extern int OURINC;
 extern std::chrono::time_point<std::chrono::high_resolution_clock> STARTTIME;
+extern int REVERSEFUTILITYMARGIN;
+extern int FUTILITYMARGIN;
+extern int LATEMOVEPRUNINGBASE;
+extern int ASPIRATIONWINDOW;
+extern int MULTIPV;
 
+// Checkmate values, symmetric around the draw value (2048) and beyond any evaluation or tablebase value.
+// Mating at a ply from the root is worth MATE_VALUE - ply and being mated MATED_VALUE + ply, so shorter mates
+// (and longer defences) are preferred.
+constexpr int16_t MATE_VALUE{30000};
+constexpr int16_t MATED_VALUE{64 * 64 - MATE_VALUE};
+
+extern bool PRINTSEARCHINFO;
+
+void initLateMoveReductions();
+// Nodes searched by all search threads in the last search
+uint64_t searchedNodes();
 std::pair<Move, int16_t> iterativeSearch(BitPosition position, int8_t start_depth, int8_t fixed_max_depth = 100);
 #endif
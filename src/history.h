@@ -0,0 +1,86 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+#include "move.h"
+#include <algorithm> // For std::min
+#include <cstdint>
+#include <cstdlib> // For std::abs
+#include <cstring> // For std::memset
+
+// Move ordering memory for quiet moves, filled during the alpha-beta search when a quiet move produces a cutoff.
+//
+// + Butterfly history: indexed by [side to move][origin square][destination square].
+// + Counter moves: the quiet move that refuted the previous move, indexed by [previous piece][previous destination square].
+// + Continuation history: indexed by [previous piece][previous destination square][moved piece][destination square],
+//   so that a quiet move is scored by how well it worked as a reply to the move just made.
+//
+// Pieces are 0 to 5 for white and 6 to 11 for black, so that both colours share the counter move and continuation tables.
+//
+// Values use gravity updates: entry += bonus - entry * |bonus| / MAX_HISTORY. Entries saturate at +-MAX_HISTORY
+// and old information decays as new bonuses come in, so the tables never need to be rescaled.
+//
+// Each search thread owns its own tables (they are not shared like the transposition table).
+
+constexpr int MAX_HISTORY{16384};
+
+struct MoveHistory
+{
+    int16_t butterfly[2][64][64];
+    Move counterMoves[12][64];
+    int16_t continuation[12][64][12][64];
+
+    void clear()
+    {
+        std::memset(butterfly, 0, sizeof(butterfly));
+        std::memset(continuation, 0, sizeof(continuation));
+        for (auto &moves : counterMoves)
+            for (auto &move : moves)
+                move = Move(0);
+    }
+
+    // Bonus given to the cutoff move (and malus to the quiet moves searched before it)
+    static int bonus(int depth) { return std::min(depth * depth * 32, MAX_HISTORY / 4); }
+
+    static void gravityUpdate(int16_t &entry, int bonus)
+    {
+        entry += bonus - entry * std::abs(bonus) / MAX_HISTORY;
+    }
+
+    // Score for a quiet move of piece (0-11) to destination square, after the previous move
+    // of previous_piece to previous_destination (previous_piece is -1 after a null move or at the root).
+    // Scores fit in the int16_t of ScoredMove.
+    int16_t quietScore(bool white, Move move, int piece, int previous_piece, int previous_destination) const
+    {
+        int score = butterfly[not white][move.getOriginSquare()][move.getDestinationSquare()];
+        if (previous_piece >= 0)
+        {
+            // The counter move goes before every other quiet move
+            if (counterMoves[previous_piece][previous_destination] == move)
+                return INT16_MAX;
+            score += continuation[previous_piece][previous_destination][piece][move.getDestinationSquare()];
+        }
+        return static_cast<int16_t>(score / 2);
+    }
+
+    // Called when a quiet move produces a cutoff. quiets_searched are the quiet moves tried before it, with their pieces.
+    void updateQuiet(bool white, int depth, Move move, int piece, int previous_piece, int previous_destination,
+                     const Move *quiets_searched, const int *quiet_pieces, int quiets_count)
+    {
+        int b = bonus(depth);
+        gravityUpdate(butterfly[not white][move.getOriginSquare()][move.getDestinationSquare()], b);
+        if (previous_piece >= 0)
+        {
+            gravityUpdate(continuation[previous_piece][previous_destination][piece][move.getDestinationSquare()], b);
+            counterMoves[previous_piece][previous_destination] = move;
+        }
+
+        for (int i = 0; i < quiets_count; ++i)
+        {
+            Move quiet = quiets_searched[i];
+            gravityUpdate(butterfly[not white][quiet.getOriginSquare()][quiet.getDestinationSquare()], -b);
+            if (previous_piece >= 0)
+                gravityUpdate(continuation[previous_piece][previous_destination][quiet_pieces[i]][quiet.getDestinationSquare()], -b);
+        }
+    }
+};
+
+#endif
@@ -28,6 +28,8 @@
  */
 
 #include "magicmoves.h"
+#include <array>
+#include <bit>
 
 #ifdef _MSC_VER
 #pragma message("MSC compatible compiler detected -- turning off warning 4312,4146")
@@ -49,7 +51,7 @@
 // C64(0x007FFCDDFCED714A - B8 10 bit
 // C64(0x003FFFCDFFD88096 - C8 10 bit
 
-alignas(32) const unsigned int magicmoves_r_shift[64] =
+alignas(32) constexpr unsigned int magicmoves_r_shift[64] =
 	{
 		52, 53, 53, 53, 53, 53, 53, 52,
 		53, 54, 54, 54, 54, 54, 54, 53,
@@ -60,7 +62,7 @@ alignas(32) const unsigned int magicmoves_r_shift[64] =
 		53, 54, 54, 54, 54, 54, 54, 53,
 		53, 54, 54, 53, 53, 53, 53, 53};
 
-alignas(32) const U64 magicmoves_r_magics[64] =
+alignas(32) constexpr U64 magicmoves_r_magics[64] =
 	{
 		C64(0x0080001020400080), C64(0x0040001000200040), C64(0x0080081000200080), C64(0x0080040800100080),
 		C64(0x0080020400080080), C64(0x0080010200040080), C64(0x0080008001000200), C64(0x0080002040800100),
@@ -78,7 +80,7 @@ alignas(32) const U64 magicmoves_r_magics[64] =
 		C64(0x0000040008008080), C64(0x0000020004008080), C64(0x0000800100020080), C64(0x0000800041000080),
 		C64(0x00FFFCDDFCED714A), C64(0x007FFCDDFCED714A), C64(0x003FFFCDFFD88096), C64(0x0000040810002101),
 		C64(0x0001000204080011), C64(0x0001000204000801), C64(0x0001000082000401), C64(0x0001FFFAABFAD1A2)};
-const U64 magicmoves_r_mask[64] =
+constexpr U64 magicmoves_r_mask[64] =
 	{
 		C64(0x000101010101017E), C64(0x000202020202027C), C64(0x000404040404047A), C64(0x0008080808080876),
 		C64(0x001010101010106E), C64(0x002020202020205E), C64(0x004040404040403E), C64(0x008080808080807E),
@@ -98,7 +100,7 @@ const U64 magicmoves_r_mask[64] =
 		C64(0x6E10101010101000), C64(0x5E20202020202000), C64(0x3E40404040404000), C64(0x7E80808080808000)};
 
 // my original tables for bishops
-alignas(32) const unsigned int magicmoves_b_shift[64] =
+alignas(32) constexpr unsigned int magicmoves_b_shift[64] =
 	{
 		58, 59, 59, 59, 59, 59, 59, 58,
 		59, 59, 59, 59, 59, 59, 59, 59,
@@ -109,7 +111,7 @@ alignas(32) const unsigned int magicmoves_b_shift[64] =
 		59, 59, 59, 59, 59, 59, 59, 59,
 		58, 59, 59, 59, 59, 59, 59, 58};
 
-alignas(32) const U64 magicmoves_b_magics[64] =
+alignas(32) constexpr U64 magicmoves_b_magics[64] =
 	{
 		C64(0x0002020202020200), C64(0x0002020202020000), C64(0x0004010202000000), C64(0x0004040080000000),
 		C64(0x0001104000000000), C64(0x0000821040000000), C64(0x0000410410400000), C64(0x0000104104104000),
@@ -128,7 +130,7 @@ alignas(32) const U64 magicmoves_b_magics[64] =
 		C64(0x0000104104104000), C64(0x0000002082082000), C64(0x0000000020841000), C64(0x0000000000208800),
 		C64(0x0000000010020200), C64(0x0000000404080200), C64(0x0000040404040400), C64(0x0002020202020200)};
 
-const U64 magicmoves_b_mask[64] =
+constexpr U64 magicmoves_b_mask[64] =
 	{
 		C64(0x0040201008040200), C64(0x0000402010080400), C64(0x0000004020100A00), C64(0x0000000040221400),
 		C64(0x0000000002442800), C64(0x0000000204085000), C64(0x0000020408102000), C64(0x0002040810204000),
@@ -168,9 +170,7 @@ const U64 *magicmoves_b_indecies[64] =
 		magicmovesbdb + 5056, magicmovesbdb + 2720, magicmovesbdb + 864, magicmovesbdb + 1248,
 		magicmovesbdb + 1632, magicmovesbdb + 2272, magicmovesbdb + 4896, magicmovesbdb + 5184};
 #else
-#ifndef PERFECT_MAGIC_HASH
-U64 magicmovesbdb[64][1 << 9];
-#else
+#ifdef PERFECT_MAGIC_HASH
 U64 magicmovesbdb[1428];
 PERFECT_MAGIC_HASH magicmoves_b_indecies[64][1 << 9];
 #endif
@@ -197,9 +197,7 @@ const U64 *magicmoves_r_indecies[64] =
 		magicmovesrdb + 90112, magicmovesrdb + 75776, magicmovesrdb + 40960, magicmovesrdb + 45056,
 		magicmovesrdb + 49152, magicmovesrdb + 55296, magicmovesrdb + 79872, magicmovesrdb + 98304};
 #else
-#ifndef PERFECT_MAGIC_HASH
-U64 magicmovesrdb[64][1 << 12];
-#else
+#ifdef PERFECT_MAGIC_HASH
 U64 magicmovesrdb[4900];
 PERFECT_MAGIC_HASH magicmoves_r_indecies[64][1 << 12];
 #endif
@@ -308,15 +306,126 @@ U64 initmagicmoves_Bmoves(const int square, const U64 occ)
 	return ret;
 }
 
+/*********COMPILE TIME DATABASES (not part of the original magicmoves)********/
+// The default and PEXT databases are computed at compile time and placed in read-only memory,
+// so that they need no initialization at startup. The subsets of each mask are enumerated with
+// the carry-rippler trick, occupancy = (occupancy - mask) & mask.
+// Attacks are computed from rays and the first blocker on them, which is cheap enough to stay
+// within the compiler's default limit of constexpr operations (initmagicmoves_Rmoves is not).
+
+// Directions 0 to 3 go to higher squares (north, east, north east, north west),
+// directions 4 to 7 to lower squares (south, west, south west, south east)
+constexpr int initmagicmoves_file_steps[8] = {0, 1, 1, -1, 0, -1, -1, 1};
+constexpr int initmagicmoves_rank_steps[8] = {1, 0, 1, 1, -1, 0, -1, -1};
+
+struct initmagicmoves_ray_table
+{
+	U64 rays[8][64];
+};
+
+constexpr initmagicmoves_ray_table initmagicmoves_rays = []
+{
+	initmagicmoves_ray_table table{};
+	for (int direction = 0; direction < 8; direction++)
+		for (int square = 0; square < 64; square++)
+		{
+			int file = square % 8 + initmagicmoves_file_steps[direction];
+			int rank = square / 8 + initmagicmoves_rank_steps[direction];
+			for (; file >= 0 && file < 8 && rank >= 0 && rank < 8; file += initmagicmoves_file_steps[direction], rank += initmagicmoves_rank_steps[direction])
+				table.rays[direction][square] |= ((U64)(1)) << (rank * 8 + file);
+		}
+	return table;
+}();
+
+// Attacks along a ray stop at the first blocker, which is included
+constexpr U64 initmagicmoves_ray_attacks(const int square, const U64 occ, const int direction)
+{
+	U64 ray = initmagicmoves_rays.rays[direction][square];
+	U64 blockers = ray & occ;
+	if (!blockers)
+		return ray;
+	int blocker = direction < 4 ? __builtin_ctzll(blockers) : 63 - __builtin_clzll(blockers);
+	return ray ^ initmagicmoves_rays.rays[direction][blocker];
+}
+
+constexpr U64 initmagicmoves_Rmoves_constexpr(const int square, const U64 occ)
+{
+	return initmagicmoves_ray_attacks(square, occ, 0) | initmagicmoves_ray_attacks(square, occ, 1) |
+		   initmagicmoves_ray_attacks(square, occ, 4) | initmagicmoves_ray_attacks(square, occ, 5);
+}
+
+constexpr U64 initmagicmoves_Bmoves_constexpr(const int square, const U64 occ)
+{
+	return initmagicmoves_ray_attacks(square, occ, 2) | initmagicmoves_ray_attacks(square, occ, 3) |
+		   initmagicmoves_ray_attacks(square, occ, 6) | initmagicmoves_ray_attacks(square, occ, 7);
+}
+
+#if !defined(MINIMIZE_MAGIC) && !defined(PERFECT_MAGIC_HASH)
+template <int Entries>
+constexpr std::array<std::array<U64, Entries>, 64> initmagicmoves_database(const U64 *mask, const U64 *magics, const unsigned int *shift,
+																		   U64 (*moves)(int, U64))
+{
+	std::array<std::array<U64, Entries>, 64> database{};
+	for (int i = 0; i < 64; i++)
+	{
+		U64 *entries = database[i].data();
+		U64 occupancy = 0;
+		do
+		{
+			entries[(occupancy * magics[i]) >> shift[i]] = moves(i, occupancy);
+			occupancy = (occupancy - mask[i]) & mask[i];
+		} while (occupancy);
+	}
+	return database;
+}
+
+alignas(64) constexpr std::array<std::array<U64, 1 << 9>, 64> magicmovesbdb{
+	initmagicmoves_database<1 << 9>(magicmoves_b_mask, magicmoves_b_magics, magicmoves_b_shift, initmagicmoves_Bmoves_constexpr)};
+alignas(64) constexpr std::array<std::array<U64, 1 << 12>, 64> magicmovesrdb{
+	initmagicmoves_database<1 << 12>(magicmoves_r_mask, magicmoves_r_magics, magicmoves_r_shift, initmagicmoves_Rmoves_constexpr)};
+#endif
+
+#ifdef USE_PEXT
+// Blocks of 2^popcount(mask) entries, one per square
+constexpr std::array<unsigned int, 64> initmagicmoves_pext_offsets(const U64 *mask)
+{
+	std::array<unsigned int, 64> offsets{};
+	for (int i = 1; i < 64; i++)
+		offsets[i] = offsets[i - 1] + (1U << std::popcount(mask[i - 1]));
+	return offsets;
+}
+
+// The subsets of a mask come in increasing order, which is the order of their _pext_u64 indices
+template <int Entries>
+constexpr std::array<U64, Entries> initmagicmoves_pext_database(const U64 *mask, const std::array<unsigned int, 64> &offsets,
+																U64 (*moves)(int, U64))
+{
+	std::array<U64, Entries> database{};
+	for (int i = 0; i < 64; i++)
+	{
+		U64 occupancy = 0;
+		U64 *entries = database.data() + offsets[i];
+		do
+		{
+			*entries++ = moves(i, occupancy);
+			occupancy = (occupancy - mask[i]) & mask[i];
+		} while (occupancy);
+	}
+	return database;
+}
+
+alignas(64) constexpr std::array<unsigned int, 64> pextmoves_b_offsets{initmagicmoves_pext_offsets(magicmoves_b_mask)};
+alignas(64) constexpr std::array<unsigned int, 64> pextmoves_r_offsets{initmagicmoves_pext_offsets(magicmoves_r_mask)};
+alignas(64) constexpr std::array<U64, 5248> pextmovesbdb{initmagicmoves_pext_database<5248>(magicmoves_b_mask, pextmoves_b_offsets, initmagicmoves_Bmoves_constexpr)};
+alignas(64) constexpr std::array<U64, 102400> pextmovesrdb{initmagicmoves_pext_database<102400>(magicmoves_r_mask, pextmoves_r_offsets, initmagicmoves_Rmoves_constexpr)};
+#endif
+
 // used so that the original indecies can be left as const so that the compiler can optimize better
 
 #ifndef PERFECT_MAGIC_HASH
 #ifdef MINIMIZE_MAGIC
 #define BmagicNOMASK2(square, occupancy) *(magicmoves_b_indecies2[square] + (((occupancy) * magicmoves_b_magics[square]) >> magicmoves_b_shift[square]))
 #define RmagicNOMASK2(square, occupancy) *(magicmoves_r_indecies2[square] + (((occupancy) * magicmoves_r_magics[square]) >> magicmoves_r_shift[square]))
-#else
-#define BmagicNOMASK2(square, occupancy) magicmovesbdb[square][((occupancy) * magicmoves_b_magics[square]) >> MINIMAL_B_BITS_SHIFT(square)]
-#define RmagicNOMASK2(square, occupancy) magicmovesrdb[square][((occupancy) * magicmoves_r_magics[square]) >> MINIMAL_R_BITS_SHIFT(square)]
 #endif
 /*#else
 	#define BmagicNOMASK2(square, occupancy) magicmovesbdb[magicmoves_b_indecies[square][((occupancy)*magicmoves_b_magics[square])>>MINIMAL_B_BITS_SHIFT]]
@@ -324,6 +433,12 @@ U64 initmagicmoves_Bmoves(const int square, const U64 occ)
 */
 #endif
 
+#if !defined(MINIMIZE_MAGIC) && !defined(PERFECT_MAGIC_HASH)
+// Nothing to do, the databases are computed at compile time
+void initmagicmoves(void)
+{
+}
+#else
 void initmagicmoves(void)
 {
 	int i;
@@ -461,4 +576,5 @@ void initmagicmoves(void)
 #endif
 		}
 	}
-}
\ No newline at end of file
+}
+#endif
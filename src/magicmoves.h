@@ -6,6 +6,8 @@
  *
  *Usage:
  *You must first initialize the generator with a call to initmagicmoves().
+ *(In this copy the default and PEXT databases are computed at compile time
+ *and initmagicmoves() only fills the MINIMIZE_MAGIC and PERFECT_MAGIC_HASH ones.)
  *Then you can use the following macros for generating move bitboards by
  *giving them a square and an occupancy.  The macro will then "return"
  *the correct move bitboard for that particular square and occupancy. It
@@ -74,6 +76,7 @@
 
 #ifndef _magicmovesh
 #define _magicmovesh
+#include <array>
 // #include <intrin.h>
 
 /*********MODIFY THE FOLLOWING IF NECESSARY********/
@@ -156,8 +159,9 @@ extern const U64 *magicmoves_r_indecies[64];
 #define RmagicNOMASK(square, occupancy) magicmovesrdb[square][((occupancy) * magicmoves_r_magics[square]) >> MINIMAL_R_BITS_SHIFT(square)]
 #endif // USE_INLINING
 
-extern U64 magicmovesbdb[64][1 << 9];
-extern U64 magicmovesrdb[64][1 << 12];
+// Computed at compile time
+extern const std::array<std::array<U64, 1 << 9>, 64> magicmovesbdb;
+extern const std::array<std::array<U64, 1 << 12>, 64> magicmovesrdb;
 
 #endif // MINIMIAZE_MAGICMOVES
 #else  // PERFCT_MAGIC_HASH defined
@@ -244,6 +248,36 @@ static inline U64 QmagicNOMASK(const unsigned int square, const U64 occupancy)
 
 #endif // USE_INLINING
 
+/*********PEXT BACKEND (not part of the original magicmoves)********/
+// If USE_PEXT is defined, BmagicNOMASK and RmagicNOMASK index dense per-square tables
+// with _pext_u64(occupancy, mask) instead of multiplying by a magic number and shifting.
+// PEXT is a single cycle on Intel since Haswell and AMD since Zen 3, but microcoded (very slow)
+// on Zen 1 and Zen 2, so it is only used when asked for at build time:
+//     g++ -DUSE_PEXT -mbmi2 ...
+// Without USE_PEXT the magic lookups above are used. The occupancy passed to the NOMASK forms
+// must still be a subset of the mask, as with the magic version.
+#ifdef USE_PEXT
+#ifndef __BMI2__
+#error magicmoves - USE_PEXT needs a BMI2 target (-mbmi2 or -march=native)
+#endif
+#include <immintrin.h>
+
+#undef BmagicNOMASK
+#undef RmagicNOMASK
+#define BmagicNOMASK(square, occupancy) pextmovesbdb[pextmoves_b_offsets[square] + _pext_u64((occupancy), magicmoves_b_mask[square])]
+#define RmagicNOMASK(square, occupancy) pextmovesrdb[pextmoves_r_offsets[square] + _pext_u64((occupancy), magicmoves_r_mask[square])]
+
+// 5248 bishop and 102400 rook entries (841kb), one block of 2^popcount(mask) entries per square
+// Computed at compile time
+extern const std::array<U64, 5248> pextmovesbdb;
+extern const std::array<U64, 102400> pextmovesrdb;
+extern const std::array<unsigned int, 64> pextmoves_b_offsets;
+extern const std::array<unsigned int, 64> pextmoves_r_offsets;
+#define SLIDER_ATTACKS_BACKEND "pext"
+#else
+#define SLIDER_ATTACKS_BACKEND "magic"
+#endif // USE_PEXT
+
 void initmagicmoves(void);
 
 #endif //_magicmoveshvesh
\ No newline at end of file
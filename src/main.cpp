@@ -15,9 +15,14 @@
 #include "nnue_ttable.h"
 #include <fstream>
 #include <vector>
+#include <deque>
 #include <cstdlib>
 #include "memory.h"
 #include "move_selectors.h"
+#include "polyglot.h"
+#include "syzygy.h"
+#include <algorithm> // For std::max
+#include <thread>
 
 
 TranspositionTable globalTT;
@@ -28,6 +33,26 @@ int OURINC{1200}; // Increment per move
 std::chrono::time_point<std::chrono::high_resolution_clock> STARTTIME; // Starting thinking time point
 int TTSIZE{23};
 
+// Shallow depth pruning parameters (UCI options)
+int REVERSEFUTILITYMARGIN{250}; // Per depth margin for reverse futility pruning
+int FUTILITYMARGIN{250}; // Per depth margin for futility pruning
+int LATEMOVEPRUNINGBASE{3}; // Quiet moves searched before late move pruning is LATEMOVEPRUNINGBASE + depth * depth
+int ASPIRATIONWINDOW{60}; // Initial half width of the aspiration window around the previous iteration's score
+int MULTIPV{1};           // Number of best root moves with exact scores, each reported with its line
+bool PRINTSEARCHINFO{true}; // Info lines after each iteration, off while benchmarking
+
+// Perft parameters (UCI options)
+int PERFTTHREADS{static_cast<int>(std::max(1U, std::thread::hardware_concurrency()))}; // Threads splitting the root moves
+int PERFTHASH{16}; // Megabytes of the perft hash table, 0 to count without it
+
+// Default bench parameters
+constexpr int BENCH_DEPTH{9};
+constexpr int BENCH_HASH{16};
+
+// Opening book parameters (UCI options)
+bool OWNBOOK{true}; // Play weighted moves from the Polyglot book while the position is in it
+polyglot::Book openingBook;
+
 void printArray(const char *name, const int16_t *array, size_t size)
 {
     std::cout << name << ": ";
@@ -38,11 +63,86 @@ void printArray(const char *name, const int16_t *array, size_t size)
     std::cout << std::endl;
 }
 
+// The legal move of the position written uci in UCI notation, Move(0) if there is none
+Move moveFromUci(const std::string &uci, BitPosition &position)
+{
+    position.setIsCheckOnInitialization();
+    MoveList<MAX_MOVES> moves{position.getIsCheck() ? position.inCheckAllMoves() : position.allMoves()};
+    for (Move move : moves)
+        if (move.toString() == uci)
+            return move;
+    return Move(0);
+}
+
+// Game set by the "position" command, kept between commands so that only the moves it didn't have yet are made
+struct UciGame
+{
+    std::string fen;
+    std::vector<std::string> moves; // UCI moves made from fen
+    std::deque<StateInfo> states;   // One per move made, which must not move in memory
+};
+
+bool makeGameMove(BitPosition &position, UciGame &game, const std::string &uci)
+// Returns false (and leaves position and game as they were) if uci isn't a legal move of the position
+{
+    Move move{moveFromUci(uci, position)};
+    if (move.getData() == 0)
+        return false;
+    game.moves.push_back(uci);
+
+    // The states of the game moves stay alive in game.states, repetition checks walk back through them
+    position.setBlockersAndPinsInAB();
+    position.makeMove(move, game.states.emplace_back());
+    return true;
+}
+
+unsigned long long runBench(int depth, int hash_megabytes)
+// Searches the bench positions to a fixed depth, each with an empty ttable and without time limits.
+// The total number of nodes is a signature of the search (the same nodes mean the same search), the time its speed.
+{
+    // Entries rounded down to a power of two
+    size_t entries{1};
+    while (entries * 2 * sizeof(TTEntry) <= static_cast<size_t>(std::max(1, hash_megabytes)) << 20)
+        entries *= 2;
+
+    int saved_time{OURTIME}, saved_inc{OURINC};
+    OURTIME = 8000000;
+    OURINC = 0;
+    PRINTSEARCHINFO = false;
+
+    unsigned long long total_nodes{0};
+    std::chrono::duration<double> duration{0};
+    int index{0};
+    for (const char *fen : BENCH_POSITIONS)
+    {
+        BitPosition bench_position{fen};
+        ENGINEISWHITE = bench_position.getTurn();
+        globalTT.resize(entries);
+
+        STARTTIME = std::chrono::high_resolution_clock::now();
+        Move best_move{iterativeSearch(bench_position, 2, static_cast<int8_t>(depth)).first};
+        duration += std::chrono::high_resolution_clock::now() - STARTTIME;
+
+        unsigned long long nodes{searchedNodes()};
+        total_nodes += nodes;
+        std::cout << "Position " << ++index << "/" << std::size(BENCH_POSITIONS) << ": " << best_move.toString() << " " << nodes << " nodes\n";
+    }
+    PRINTSEARCHINFO = true;
+    OURTIME = saved_time;
+    OURINC = saved_inc;
+    globalTT.resize(1 << TTSIZE);
+
+    std::cout << "\nNodes searched: " << total_nodes << "\n";
+    std::cout << "Time taken: " << duration.count() << " seconds\n";
+    std::cout << "Nodes per second: " << static_cast<unsigned long long>(total_nodes / duration.count()) << "\n" << std::flush;
+    return total_nodes;
+}
+
 Move findNormalMoveFromString(std::string moveString, BitPosition position)
 {
     if (position.getIsCheck())
     {
-        std::vector<Move> moves{position.inCheckAllMoves()};
+        MoveList<MAX_MOVES> moves{position.inCheckAllMoves()};
         for (Move move : moves)
         {
             if (move.toString() == moveString)
@@ -51,7 +151,7 @@ Move findNormalMoveFromString(std::string moveString, BitPosition position)
     }
     else
     {
-        std::vector<Move> moves{position.allMoves()};
+        MoveList<MAX_MOVES> moves{position.allMoves()};
         for (Move move : moves)
         {
             if (move.toString() == moveString)
@@ -109,32 +209,38 @@ Move findCaptureMoveFromString(std::string moveString, BitPosition position)
     return Move(0);
 }
 
-int main()
+int main(int argc, char *argv[])
 {
     int startDepth = 1;
 
     // Initialize std::vectors of NNUEInput layers as global variables
     NNUEU::initNNUEParameters();
-    precomputed_moves::init_precomputed_moves();
     // precomputed_moves::pretty_print_all();
 
-    // Initialize magic numbers and zobrist numbers
+    // Precomputed moves, magic moves and zobrist numbers are computed at compile time.
+    // This only fills the magic databases of the MINIMIZE_MAGIC and PERFECT_MAGIC_HASH layouts.
     initmagicmoves();
-    zobrist_keys::initializeZobristNumbers();
+
+    // Initialize search tables
+    initLateMoveReductions();
 
     // zobrist_keys::printAllZobristKeys();
 
     // Initialize position object
     std::string inputLine;
     std::string lastFen; // Variable to store the last FEN string
+    UciGame game;
     BitPosition position{BitPosition("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1")};
-    StateInfo state_info;
 
     globalTT.resize(1 << TTSIZE);
 
-    bool fromStart;
-    int movesMade = 0;
-    Move lastMove;
+    // Benchmark from the command line: bench [depth] [hash]
+    if (argc > 1 && std::string(argv[1]) == "bench")
+    {
+        runBench(argc > 2 ? std::atoi(argv[2]) : BENCH_DEPTH, argc > 3 ? std::atoi(argv[3]) : BENCH_HASH);
+        return 0;
+    }
+
     // Simple loop to read commands from the Python GUI following UCI communication protocol
     while (std::getline(std::cin, inputLine))
     {
@@ -146,8 +252,59 @@ int main()
         {
             std::cout << "id name La_Mano_de_Tahl\n" << std::flush;
             std::cout << "id author Miguel_Cordoba\n" << std::flush;
+            std::cout << "option name ReverseFutilityMargin type spin default 250 min 0 max 2000\n";
+            std::cout << "option name FutilityMargin type spin default 250 min 0 max 2000\n";
+            std::cout << "option name LateMovePruningBase type spin default 3 min 0 max 64\n";
+            std::cout << "option name AspirationWindow type spin default 60 min 1 max 2000\n";
+            std::cout << "option name MultiPV type spin default 1 min 1 max 256\n";
+            std::cout << "option name PerftThreads type spin default " << PERFTTHREADS << " min 1 max 256\n";
+            std::cout << "option name PerftHash type spin default 16 min 0 max 65536\n";
+            std::cout << "option name OwnBook type check default true\n";
+            std::cout << "option name BookFile type string default <empty>\n";
+            std::cout << "option name SyzygyPath type string default <empty>\n";
+            std::cout << "option name SyzygyProbeLimit type spin default 7 min 0 max 7\n";
             std::cout << "uciok\n" << std::flush;
         }
+        // Setting engine options: setoption name <name> value <value>
+        else if (command == "setoption")
+        {
+            std::string name, value;
+            iss >> command >> name >> command >> value;
+            if (name == "ReverseFutilityMargin")
+                REVERSEFUTILITYMARGIN = std::stoi(value);
+            else if (name == "FutilityMargin")
+                FUTILITYMARGIN = std::stoi(value);
+            else if (name == "LateMovePruningBase")
+                LATEMOVEPRUNINGBASE = std::stoi(value);
+            else if (name == "AspirationWindow")
+                ASPIRATIONWINDOW = std::stoi(value);
+            else if (name == "MultiPV")
+                MULTIPV = std::max(1, std::stoi(value));
+            else if (name == "PerftThreads")
+                PERFTTHREADS = std::max(1, std::stoi(value));
+            else if (name == "PerftHash")
+                PERFTHASH = std::max(0, std::stoi(value));
+            else if (name == "OwnBook")
+                OWNBOOK = (value == "true");
+            else if (name == "BookFile")
+            {
+                // Paths may contain spaces
+                std::string rest;
+                std::getline(iss, rest);
+                std::string path{value + rest};
+                if (not openingBook.open(path) && path != "<empty>")
+                    std::cout << "info string Could not load " << path << "\n" << std::flush;
+            }
+            else if (name == "SyzygyPath")
+            {
+                std::string rest;
+                std::getline(iss, rest);
+                int pieces{syzygy::init(value + rest)};
+                std::cout << "info string Syzygy tablebases found up to " << pieces << " pieces\n" << std::flush;
+            }
+            else if (name == "SyzygyProbeLimit")
+                syzygy::setProbeLimit(std::max(0, std::stoi(value)));
+        }
         else if (command == "isready")
         {
             std::cout << "readyok\n";
@@ -165,13 +322,11 @@ int main()
             std::string line;
             if (command == "startpos")
             {
-                fromStart = true;
                 fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
                 iss >> command; // Consume the 'moves' token if it's there
             }
             else if (command == "fen")
             {
-                fromStart = false;
                 std::string line;
                 std::getline(iss, line);
 
@@ -205,33 +360,31 @@ int main()
                 }
             }
 
-            position = BitPosition(fen);
-
-            Move move;
+            std::vector<std::string> moves;
             while (iss >> command)
-            {
-                // Apply each move in the moves list
-                std::string moveUci{command};
-                move = findNormalMoveFromString(moveUci, position);
-                if (move.getData() != 0)
-                    lastMove = move;
-                bool reseterMove{false};
+                moves.push_back(command);
 
-                if (move.getData() != 0)
+            // If the moves extend the ones already made on the same position (the usual case, where the GUI repeats
+            // the whole game followed by the opponent's move) only the new ones are made
+            bool extendsGame{fen == game.fen && moves.size() >= game.moves.size() &&
+                             std::equal(game.moves.begin(), game.moves.end(), moves.begin())};
+            if (not extendsGame)
+            {
+                position = BitPosition(fen);
+                game.fen = fen;
+                game.moves.clear();
+                game.states.clear();
+            }
+            size_t movesMade{game.moves.size()};
+            // The moves after an illegal one would be made on the wrong position, so they are dropped
+            for (size_t i = movesMade; i < moves.size(); ++i)
+                if (not makeGameMove(position, game, moves[i]))
                 {
-                    if (position.moveIsReseter(move))
-                        reseterMove = true;
-                    position.setBlockersAndPinsInAB();
-                    position.makeMove(move, state_info);
-                    movesMade++;
+                    std::cout << "info string Illegal move " << moves[i] << "\n" << std::flush;
+                    break;
                 }
-
-                // If we make a capture we cant go back to previous positions so we empty
-                // the plyInfo (for threefold checking) in position
-                if (reseterMove)
-                    position.resetPlyInfo();
+            if (game.moves.size() > movesMade)
                 globalTT.resize(1 << TTSIZE);
-            }
         }
         // Thinking after opponent made move
         else if (inputLine.substr(0, 2) == "go")
@@ -249,41 +402,19 @@ int main()
                 else if (command == "binc" && (ENGINEISWHITE==false))
                     iss >> OURINC;
             }
-            if (fromStart && movesMade == 0)
+            // Book moves are played without searching
+            Move bookMove;
+            if (OWNBOOK && openingBook.isOpen())
             {
-                // Return a random move
-                std::array<std::string, 2> opening_moves = {"e2e4", "d2d4"};
-                std::random_device rd;
-                std::mt19937 gen(rd());
-                std::uniform_int_distribution<int> dist(0, 1);
-
-                std::string random_move = opening_moves[dist(gen)];
-                std::cout << "bestmove " << random_move << "\n"
-                          << std::flush;
-            }
-            else if ((fromStart) && (movesMade == 1) && (lastMove.toString() == "e2e4"))
-            {
-                // Return a random move
-                std::array<std::string, 2> opening_moves = {"e7e5", "c7c6"};
-                std::random_device rd;
-                std::mt19937 gen(rd());
-                std::uniform_int_distribution<int> dist(0, 1);
-
-                std::string random_move = opening_moves[dist(gen)];
-                std::cout << "bestmove " << random_move << "\n"
-                          << std::flush;
+                std::string bookMoveUci{openingBook.pickMove(position)};
+                if (not bookMoveUci.empty())
+                    bookMove = findNormalMoveFromString(bookMoveUci, position);
             }
-            else if ((fromStart) && (movesMade == 1) && (lastMove.toString() == "d2d4"))
+            if (bookMove.getData() != 0)
             {
-                // Return a random move
-                std::array<std::string, 2> opening_moves = {"d7d5", "g8f6"};
-                std::random_device rd;
-                std::mt19937 gen(rd());
-                std::uniform_int_distribution<int> dist(0, 1);
-
-                std::string random_move = opening_moves[dist(gen)];
-                std::cout << "bestmove " << random_move << "\n"
+                std::cout << "bestmove " << bookMove.toString() << "\n"
                           << std::flush;
+                makeGameMove(position, game, bookMove.toString());
             }
             else
             {
@@ -295,10 +426,15 @@ int main()
 
                 // Send our best move through a UCI command
                 // std::cout << "Eval: " << bestValue << "\n";
-                std::cout << "bestmove " << bestMove.toString() << "\n" << std::flush;
-
-                // Static eval after making move (testing purposes)
-                position.makeMove(bestMove, state_info);
+                // A mated or stalemated side has no move, UCI writes the null move 0000
+                if (bestMove.getData() == 0)
+                    std::cout << "bestmove 0000\n" << std::flush;
+                else
+                {
+                    std::cout << "bestmove " << bestMove.toString() << "\n" << std::flush;
+                    // The GUI's next position is expected to extend the game with this move
+                    makeGameMove(position, game, bestMove.toString());
+                }
 
                 // position.printZobristKeys();
                 // position.print50MoveCount();
@@ -311,6 +447,120 @@ int main()
         ////////////////////////////////////////////////////////////
         // Some tests to see efficiency and algorithm correctness
         ////////////////////////////////////////////////////////////
+
+        // Polyglot key and book moves (with their weights) of the current position
+        else if (command == "book")
+        {
+            std::cout << "Polyglot key: " << std::hex << polyglot::key(position) << std::dec << "\n";
+            auto bookMoves{openingBook.moves(position)};
+            if (bookMoves.empty())
+                std::cout << "No book moves\n";
+            for (const auto &[move, weight] : bookMoves)
+                std::cout << move << " weight " << weight << "\n";
+        }
+
+        // Searches of the bench positions: bench [depth] [hash]
+        else if (command == "bench")
+        {
+            // Missing parameters keep their defaults
+            int parameters[2]{BENCH_DEPTH, BENCH_HASH};
+            for (int &parameter : parameters)
+            {
+                int value;
+                if (not (iss >> value))
+                    break;
+                parameter = value;
+            }
+            runBench(parameters[0], parameters[1]);
+        }
+
+        // Perft of the current position or of a given one: perft <depth> [fen]
+        else if (command == "perft")
+        {
+            int depth{0};
+            iss >> depth;
+            std::string fen;
+            std::getline(iss, fen);
+            if (!fen.empty() && fen[0] == ' ')
+                fen.erase(0, 1);
+            BitPosition perft_position{fen.empty() ? position : BitPosition(fen)};
+
+            auto start = std::chrono::high_resolution_clock::now(); // Start timing
+            unsigned long long nodes{runPerft(perft_position, depth, PERFTTHREADS, PERFTHASH)};
+            std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+
+            std::cout << "\nNodes searched: " << nodes << "\n";
+            std::cout << "Time taken: " << duration.count() << " seconds\n";
+            std::cout << "Nodes per second: " << static_cast<unsigned long long>(nodes / duration.count()) << "\n" << std::flush;
+        }
+
+        // Copy-make against make/unmake: same node counts and nodes per second of each (one thread, no perft hash)
+        else if (command == "copyMakeTests")
+        {
+            bool equal{true};
+            unsigned long long total_nodes{0};
+            std::chrono::duration<double> make_unmake_time{0}, copy_make_time{0};
+            for (const PerftSuiteEntry &entry : PERFT_SUITE)
+            {
+                BitPosition make_unmake_position{BitPosition(entry.fen)};
+                auto start = std::chrono::high_resolution_clock::now();
+                unsigned long long make_unmake_nodes{perft(make_unmake_position, entry.depth - 1, nullptr)};
+                make_unmake_time += std::chrono::high_resolution_clock::now() - start;
+
+                BitPosition copy_make_position{BitPosition(entry.fen)};
+                start = std::chrono::high_resolution_clock::now();
+                unsigned long long copy_make_nodes{perftCopyMake(copy_make_position, entry.depth - 1)};
+                copy_make_time += std::chrono::high_resolution_clock::now() - start;
+
+                total_nodes += make_unmake_nodes;
+                equal = equal && make_unmake_nodes == copy_make_nodes;
+                std::cout << (make_unmake_nodes == copy_make_nodes ? "ok    " : "FAILED") << " depth " << entry.depth - 1 << " make/unmake " << make_unmake_nodes << " copy-make " << copy_make_nodes << " " << entry.fen << "\n" << std::flush;
+            }
+            std::cout << (equal ? "Copy-make and make/unmake node counts are equal\n" : "Copy-make and make/unmake node counts DIFFER\n");
+            std::cout << "Make/unmake nodes per second: " << static_cast<unsigned long long>(total_nodes / make_unmake_time.count()) << "\n";
+            std::cout << "Copy-make nodes per second: " << static_cast<unsigned long long>(total_nodes / copy_make_time.count()) << "\n" << std::flush;
+        }
+
+        // Full NNUE accumulator refreshes (as done at the start of every search) per second, on the perft suite positions
+        else if (command == "accumulatorRefreshTests")
+        {
+            constexpr int REFRESHES{200000};
+            unsigned long long total_refreshes{0};
+            auto start = std::chrono::high_resolution_clock::now(); // Start timing
+            for (const PerftSuiteEntry &entry : PERFT_SUITE)
+            {
+                BitPosition refresh_position{BitPosition(entry.fen)};
+                for (int i = 0; i < REFRESHES; ++i)
+                    refresh_position.initializeNNUEInput();
+                total_refreshes += REFRESHES;
+                std::cout << "Eval " << refresh_position.evaluationFunction(true) << " " << entry.fen << "\n";
+            }
+            std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+
+            std::cout << "Time taken: " << duration.count() << " seconds\n";
+            std::cout << "Refreshes per second: " << static_cast<unsigned long long>(total_refreshes / duration.count()) << "\n" << std::flush;
+        }
+
+        // Standard perft positions checked against their known node counts
+        else if (command == "perftSuite")
+        {
+            bool passed{true};
+            unsigned long long total_nodes{0};
+            auto start = std::chrono::high_resolution_clock::now(); // Start timing
+            for (const PerftSuiteEntry &entry : PERFT_SUITE)
+            {
+                BitPosition suite_position{BitPosition(entry.fen)};
+                unsigned long long nodes{runPerft(suite_position, entry.depth, PERFTTHREADS, PERFTHASH, false)};
+                total_nodes += nodes;
+                passed = passed && nodes == entry.nodes;
+                std::cout << (nodes == entry.nodes ? "ok    " : "FAILED") << " depth " << entry.depth << " " << nodes << " (expected " << entry.nodes << ") " << entry.fen << "\n" << std::flush;
+            }
+            std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+
+            std::cout << (passed ? "All perft tests passed\n" : "Some perft tests FAILED\n");
+            std::cout << "Time taken: " << duration.count() << " seconds\n";
+            std::cout << "Nodes per second: " << static_cast<unsigned long long>(total_nodes / duration.count()) << "\n" << std::flush;
+        }
         
         // Test allMoves and inCheckAllMoves generators efficiency
         else if (inputLine == "firstMovesPerftTests")
@@ -537,6 +787,46 @@ int main()
             std::cout << "Time taken: " << duration.count() << " seconds\n";
         }
 
+        else if (inputLine == "stagedPerftTests")
+        {
+            int maxDepth;
+            std::cout << "Max depth: \n";
+            while (!(std::cin >> maxDepth))
+            {
+                std::cin.clear();                                                   // clear the error flag
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // discard invalid input
+                std::cout << "Invalid input. Please enter a integer: \n";
+            }
+            std::cout << "Starting test\n";
+
+            const std::string fens[6]{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                                      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                                      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+                                      "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+                                      "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+                                      "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10 "};
+
+            unsigned long long nodes{0};
+            auto start = std::chrono::high_resolution_clock::now(); // Start timing
+            for (int i = 0; i < 6; ++i)
+            {
+                std::cout << "Position " << i + 1 << " \n";
+                globalTT.resize(1 << TTSIZE);
+                // Each iteration uses the last moves of the previous one as tt moves, so that every stage skips them
+                for (int8_t depth = 1; depth <= maxDepth; ++depth)
+                {
+                    BitPosition position{BitPosition(fens[i])};
+                    unsigned long long depthNodes{runStagedPerftTest(position, depth)};
+                    nodes += depthNodes;
+                    std::cout << depthNodes << " moves\n";
+                }
+            }
+            std::chrono::duration<double> duration = std::chrono::high_resolution_clock::now() - start;
+
+            std::cout << "Time taken: " << duration.count() << " seconds\n";
+            std::cout << "Nodes per second (" << SLIDER_ATTACKS_BACKEND << " slider attacks): " << static_cast<uint64_t>(nodes / duration.count()) << "\n";
+        }
+
         else if (inputLine == "nonPVPerftTests")
         {
             int maxDepth;
@@ -912,7 +1202,7 @@ int main()
         else if (inputLine == "threefoldTest")
         {
             BitPosition position_1{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"};
-            StateInfo state_info;
+            std::deque<StateInfo> states; // Repetition checks walk back through the states of the moves made
 
             auto checkAndMakeMove = [&](const std::string &moveStr)
             {
@@ -921,7 +1211,7 @@ int main()
                     std::cout << "Draw\n";
                 else
                     std::cout << "Not Draw\n";
-                position_1.makeMove(move, state_info);
+                position_1.makeMove(move, states.emplace_back());
             };
 
             checkAndMakeMove("b1a3"); // Not draw
@@ -946,7 +1236,118 @@ int main()
 
             position_1.printZobristKeys();
         }
-        
+
+        // Test repetitions past 128 plies and upcoming repetitions (cuckoo tables)
+        else if (inputLine == "repetitionTests")
+        {
+            bool passed{true};
+            auto check = [&](const std::string &name, bool result, bool expected)
+            {
+                passed = passed && result == expected;
+                std::cout << (result == expected ? "ok     " : "FAILED ") << name << ": " << result << " (expected " << expected << ")\n";
+            };
+            // Repetition checks walk back through the states of the moves made, so each move gets its own
+            auto makeMoves = [&](BitPosition &position_1, std::deque<StateInfo> &states, const std::string &moves)
+            {
+                std::istringstream moves_stream(moves);
+                std::string move_string;
+                while (moves_stream >> move_string)
+                    position_1.makeMove(findNormalMoveFromString(move_string, position_1), states.emplace_back());
+            };
+
+            // 160 plies of king walks between pawn moves, then the last king walk repeated until threefold
+            {
+                BitPosition position_1{"4k3/pppppppp/8/8/8/8/PPPPPPPP/4K3 w - - 0 1"};
+                std::deque<StateInfo> states;
+                for (char file = 'a'; file <= 'h'; ++file)
+                    for (int step = 0; step < 2; ++step)
+                    {
+                        makeMoves(position_1, states, "e1f1 e8f8 f1g1 f8g8 g1f1 g8f8 f1e1 f8e8");
+                        std::string file_string(1, file);
+                        makeMoves(position_1, states, file_string + std::to_string(2 + step) + file_string + std::to_string(3 + step) + " " +
+                                                          file_string + std::to_string(7 - step) + file_string + std::to_string(6 - step));
+                    }
+                check("No draw after " + std::to_string(position_1.getPly()) + " plies", position_1.isDraw(), false);
+                makeMoves(position_1, states, "e1f1 e8f8 f1e1 f8e8");
+                check("Second occurrence", position_1.isDraw(), false);
+                makeMoves(position_1, states, "e1f1 e8f8 f1e1 f8e8");
+                check("Threefold repetition after " + std::to_string(position_1.getPly()) + " plies", position_1.isDraw(), true);
+            }
+            // A knight can go back to the starting position
+            {
+                BitPosition position_1{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"};
+                std::deque<StateInfo> states;
+                makeMoves(position_1, states, "g1f3 g8f6 f3g1");
+                check("Upcoming repetition in search", position_1.hasUpcomingRepetition(4), true);
+                check("Upcoming repetition of a position before the root played once", position_1.hasUpcomingRepetition(0), false);
+                makeMoves(position_1, states, "f6g8 g1f3 g8f6 f3g1");
+                check("Upcoming repetition of a position before the root played twice", position_1.hasUpcomingRepetition(0), true);
+            }
+            {
+                BitPosition position_1{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"};
+                std::deque<StateInfo> states;
+                makeMoves(position_1, states, "e2e4 e7e5 g1f3");
+                check("Upcoming repetition after irreversible moves", position_1.hasUpcomingRepetition(4), false);
+            }
+            // The rook went a8-b8-b4-a4, it can only go back to a8 in one move if a6 is empty
+            {
+                BitPosition position_1{"r3k3/8/8/8/8/8/8/4K3 w - - 0 1"};
+                std::deque<StateInfo> states;
+                makeMoves(position_1, states, "e1d1 a8b8 d1c1 b8b4 c1d1 b4a4 d1e1");
+                check("Upcoming repetition with an empty path", position_1.hasUpcomingRepetition(8), true);
+            }
+            {
+                BitPosition position_1{"r3k3/8/P7/8/8/8/8/4K3 w - - 0 1"};
+                std::deque<StateInfo> states;
+                makeMoves(position_1, states, "e1d1 a8b8 d1c1 b8b4 c1d1 b4a4 d1e1");
+                check("Upcoming repetition with a blocked path", position_1.hasUpcomingRepetition(8), false);
+            }
+            // Null moves keep the 50 move count, but repetitions are not looked for through them
+            {
+                BitPosition position_1{"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"};
+                std::deque<StateInfo> states;
+                makeMoves(position_1, states, "g1f3 g8f6 f3g1 f6g8");
+                position_1.makeNullMove(states.emplace_back());
+                position_1.makeNullMove(states.emplace_back());
+                makeMoves(position_1, states, "g1f3 g8f6 f3g1 f6g8");
+                check("50 move count through null moves", position_1.getReversibleMovesMade() == 8, true);
+                check("Threefold repetition through null moves", position_1.isDraw(), false);
+            }
+            std::cout << (passed ? "All repetition tests passed\n" : "Some repetition tests FAILED\n") << std::flush;
+        }
+
+        // Mates in N searched to 2N plies: the value must be the shortest mate, and the time to find it is printed
+        else if (inputLine == "mateTests")
+        {
+            const std::pair<std::string, int> mates[]{
+                {"6k1/5ppp/8/8/8/8/5PPP/1R4K1 w - - 0 1", 1},
+                {"1r4k1/5ppp/8/8/8/8/5PPP/6K1 b - - 0 1", 1},
+                {"4k3/Q6n/8/8/8/8/PR5P/4K1NR w K - 0 1", 1},
+                {"7k/8/8/8/8/8/R7/1R4K1 w - - 0 1", 2},
+                {"kbK5/pp6/1P6/8/8/8/8/R7 w - - 0 1", 2},
+                {"r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 1", 2},
+            };
+            bool passed{true};
+            OURTIME = 8000000;
+            OURINC = 0;
+            for (const auto &[fen, moves] : mates)
+            {
+                BitPosition mate_position{fen};
+                ENGINEISWHITE = mate_position.getTurn();
+                globalTT.resize(1 << TTSIZE);
+                STARTTIME = std::chrono::high_resolution_clock::now();
+                // One ply more than the mate, since root moves far behind the best of the previous iteration are searched a ply shorter
+                std::pair<Move, int16_t> result{iterativeSearch(mate_position, 1, static_cast<int8_t>(2 * moves + 1))};
+                std::chrono::duration<double, std::milli> duration = std::chrono::high_resolution_clock::now() - STARTTIME;
+
+                bool found{result.second == MATE_VALUE - (2 * moves - 1)};
+                passed = passed && found;
+                std::cout << (found ? "ok     " : "FAILED ") << fen << ": " << result.first.toString() << " mate in " << moves
+                          << " (value " << result.second << ", " << duration.count() << " ms)\n";
+            }
+            std::cout << (passed ? "All mate tests passed\n" : "Some mate tests FAILED\n") << std::flush;
+        }
+
         // Generate data for NNUE further training
         else if (inputLine == "generateData")
         {
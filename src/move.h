@@ -37,11 +37,11 @@ protected:
     uint16_t data;
 
 public:
-    Move() : data{0} {}
-    explicit Move(uint16_t value) : data{value} {}
+    constexpr Move() : data{0} {}
+    constexpr explicit Move(uint16_t value) : data{value} {}
 
     // Neither checks or promotion
-    explicit Move(int origin, int destination)
+    constexpr explicit Move(int origin, int destination)
         : data{static_cast<uint16_t>(origin | (destination << 6))}
     {
     }
@@ -50,7 +50,7 @@ public:
     {
         data = static_cast<uint16_t>(origin | (destination << 6) | (promotionPiece << 12) | 0x4000);
     }
-    uint16_t getData() const { return data; }
+    constexpr uint16_t getData() const { return data; }
 
     int getOriginSquare() const { return data & 63; }
     int getDestinationSquare() const { return (data >> 6) & 63; }
@@ -95,22 +95,59 @@ public:
 };
 
 // Moves which contain a score
+// Packed in 32 bits, read as an int32_t (little endian) it is (score << 16 | move), so that the
+// best move of a list can be found with a SIMD max scan (see pick_best in move_selectors.cpp)
 struct ScoredMove : public Move
 {
-    int8_t score;
+    int16_t score;
 
     // This is so that we can assign efficiently Move object to a *ScoredMove object
     void operator=(Move m) { data = m.getData(); }
 
     // Constructor to initialize both data (from Move) and score
-    ScoredMove(int dataValue = 0, int8_t scoreValue = 0)
+    ScoredMove(int dataValue = 0, int16_t scoreValue = 0)
         : Move(dataValue), score(scoreValue) {}
 
 };
+static_assert(sizeof(ScoredMove) == 4, "ScoredMove must be packed as (score, move) in 32 bits");
 
 // For move ordering
 inline bool operator<(const ScoredMove &a, const ScoredMove &b) { return a.score < b.score; }
 
+// List with a fixed capacity, stored inline so that building it never allocates.
+// Used for the move lists outside the search (root moves, UCI parsing and tests), which were std::vectors.
+template <typename T, int Capacity>
+class FixedList
+{
+    T m_items[Capacity];
+    int m_size{0};
+
+public:
+    void push_back(T item) { m_items[m_size++] = item; }
+    void resize(int size, T value)
+    {
+        for (int i = m_size; i < size; ++i)
+            m_items[i] = value;
+        m_size = size;
+    }
+    void clear() { m_size = 0; }
+
+    int size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    T &operator[](int i) { return m_items[i]; }
+    const T &operator[](int i) const { return m_items[i]; }
+    T *begin() { return m_items; }
+    T *end() { return m_items + m_size; }
+    const T *begin() const { return m_items; }
+    const T *end() const { return m_items + m_size; }
+};
+
+// No chess position has more than 218 legal moves
+constexpr int MAX_MOVES{256};
+
+template <int Capacity>
+using MoveList = FixedList<Move, Capacity>;
+
 // Hash specialization for Move
 namespace std
 {
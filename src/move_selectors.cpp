@@ -1,7 +1,9 @@
 #include "move_selectors.h"
 
 #include <array>
+#include <utility> // For std::swap
 #include "bitposition.h"
+#include "simd.h"
 
 
 // Sort moves in descending order up to and including a given limit.
@@ -18,16 +20,52 @@ void sort_moves(ScoredMove *begin, ScoredMove *end)
     }
 }
 
+// Moves the best scored move of [begin, end) to begin, so that moves are only ordered as far as they are used.
+// A ScoredMove read as an int32_t is (score << 16 | move), so the best move is the maximum of those.
+inline void pick_best(ScoredMove *begin, ScoredMove *end)
+{
+    int best{argmax_int32(reinterpret_cast<const int32_t *>(begin), static_cast<int>(end - begin))};
+    std::swap(begin[0], begin[best]);
+}
+
+// Most cutoffs happen in the first moves, which are picked one by one.
+// If a stage goes on past them, the rest of the list is sorted once instead.
+constexpr int PICKS_BEFORE_SORT{3};
+
+void ABMoveSelectorNotCheck::select_next()
+{
+    if (picked < PICKS_BEFORE_SORT)
+    {
+        pick_best(cur, endMoves);
+        if (++picked == PICKS_BEFORE_SORT)
+            sort_moves(cur + 1, endMoves);
+    }
+}
+
 // Assigns a score to each move, used for sorting.
 void ABMoveSelectorNotCheck::score()
 {
     for (auto &move : *this)
-        move.score = pos.qSMoveValue(move);
+        move.score = pos.aBMoveValue(move);
+}
+void ABMoveSelectorNotCheck::score_quiets()
+{
+    if (history == nullptr)
+    {
+        for (auto &move : *this)
+            move.score = pos.aBMoveValue(move);
+        return;
+    }
+    bool white{pos.getTurn()};
+    int previous_piece{pos.previousPiece()};
+    int previous_destination{pos.previousDestination()};
+    for (auto &move : *this)
+        move.score = history->quietScore(white, move, pos.movingPiece(move), previous_piece, previous_destination);
 }
 void QSMoveSelectorNotCheck::score()
 {
     for (auto &move : *this)
-        move.score = pos.aBMoveValue(move);
+        move.score = pos.qSMoveValue(move);
 }
 
 // This never returns the TT move, as it was emitted before.
@@ -50,6 +88,8 @@ Move QSMoveSelectorCheck::select_legal()
 Move QSMoveSelectorNotCheck::select_legal()
 {
     for (; cur < endMoves; ++cur)
+    {
+        pick_best(cur, endMoves);
         if (*cur != ttMove)
         {
             // We only set blockers once if there is a legal move
@@ -61,6 +101,7 @@ Move QSMoveSelectorNotCheck::select_legal()
                 return *cur++;
             }
         }
+    }
     return Move(0);
 }
 Move QSMoveSelectorCheckNonCaptures::select_legal()
@@ -112,6 +153,75 @@ Move ABMoveSelectorNotCheck::select_legal()
     return Move(0);
 }
 
+// Staged AB Search (not in check)
+Move ABMoveSelectorNotCheck::next_move()
+{
+    switch (stage)
+    {
+    case Stage::CapturesInit:
+        cur = endMoves = endBadCaptures = moves;
+        endMoves = pos.pawnCapturesAndQueenProms(endMoves);
+        endMoves = pos.knightCaptures(endMoves);
+        endMoves = pos.bishopCaptures(endMoves);
+        endMoves = pos.rookCaptures(endMoves);
+        endMoves = pos.queenCaptures(endMoves);
+        endMoves = pos.kingCaptures(endMoves);
+        score();
+        picked = 0;
+        stage = Stage::GoodCaptures;
+        [[fallthrough]];
+
+    case Stage::GoodCaptures:
+        for (; cur < endMoves; ++cur)
+        {
+            select_next();
+            if (*cur != ttMove && pos.isCaptureLegal(cur))
+            {
+                // Captures losing material are kept at the front of the list for the last stage
+                if (pos.seeGe(*cur))
+                    return *cur++;
+                *endBadCaptures++ = *cur;
+            }
+        }
+        stage = Stage::QuietsInit;
+        [[fallthrough]];
+
+    case Stage::QuietsInit:
+        cur = endMoves = endBadCaptures;
+        endMoves = pos.pawnNonCapturesNonQueenProms(endMoves);
+        endMoves = pos.knightNonCaptures(endMoves);
+        endMoves = pos.bishopNonCaptures(endMoves);
+        endMoves = pos.rookNonCaptures(endMoves);
+        endMoves = pos.queenNonCaptures(endMoves);
+        endMoves = pos.kingNonCaptures(endMoves);
+        score_quiets();
+        picked = 0;
+        stage = Stage::Quiets;
+        [[fallthrough]];
+
+    case Stage::Quiets:
+        for (; cur < endMoves; ++cur)
+        {
+            select_next();
+            if (*cur != ttMove && pos.isLegal(cur))
+                return *cur++;
+        }
+        cur = moves;
+        stage = Stage::BadCaptures;
+        [[fallthrough]];
+
+    case Stage::BadCaptures:
+        if (cur < endBadCaptures)
+            return *cur++;
+        stage = Stage::End;
+        [[fallthrough]];
+
+    case Stage::End:
+        break;
+    }
+    return Move(0);
+}
+
 // Qscence Search
 void QSMoveSelectorNotCheck::init()
 {
@@ -123,7 +233,6 @@ void QSMoveSelectorNotCheck::init()
     endMoves = pos.queenCaptures(endMoves);
     endMoves = pos.kingCaptures(endMoves);
     score();
-    sort_moves(cur, endMoves);
 }
 void QSMoveSelectorCheck::init()
 {
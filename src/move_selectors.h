@@ -3,6 +3,7 @@
 
 #include "bitposition.h"
 #include "move.h"
+#include "history.h"
 
 class BitPosition;
 
@@ -120,7 +121,8 @@ class ABMoveSelectorNotCheck
 public:
     ABMoveSelectorNotCheck(const ABMoveSelectorNotCheck &) = delete;
     ABMoveSelectorNotCheck &operator=(const ABMoveSelectorNotCheck &) = delete;
-    ABMoveSelectorNotCheck(BitPosition & p, Move m) : pos(p), ttMove(m) {};
+    // Without history tables (as in tests) quiet moves are ordered as captures, by aBMoveValue
+    ABMoveSelectorNotCheck(BitPosition & p, Move m, const MoveHistory *h = nullptr) : pos(p), ttMove(m), history(h) {};
     // AB Search (PV nodes)
     void init_all();
     // AB Search (Non PV nodes)
@@ -130,14 +132,34 @@ public:
 
     Move select_legal();
 
+    // Staged AB Search, moves are generated lazily stage by stage:
+    // good captures (and queen promotions), quiet moves (counter move first, then by history) and bad captures.
+    // The tt move is never returned, as it was searched before.
+    Move next_move();
+
 private:
+    enum class Stage
+    {
+        CapturesInit,
+        GoodCaptures,
+        QuietsInit,
+        Quiets,
+        BadCaptures,
+        End
+    };
+
     void score();
+    void score_quiets();
+    void select_next();
     ScoredMove *begin() { return cur; }
     ScoredMove *end() { return endMoves; }
 
     BitPosition &pos;
     Move ttMove;
-    ScoredMove *cur, *endMoves;
+    const MoveHistory *history;
+    Stage stage{Stage::CapturesInit};
+    int picked; // Moves picked in the current stage before sorting the rest
+    ScoredMove *cur, *endMoves, *endBadCaptures;
     ScoredMove moves[256];
 };
 
@@ -0,0 +1,58 @@
+#ifndef POLYGLOT_H
+#define POLYGLOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility> // For std::pair
+#include <vector>
+#include "bitposition.h"
+
+// Opening books in the Polyglot format.
+//
+// A book is a file of 16 byte big endian entries sorted by key:
+//
+// key      64 bit   Polyglot key of the position
+// move     16 bit   destination file (bits 0-2) and row (3-5), origin file (6-8) and row (9-11),
+//                   promotion piece (12-14: none, knight, bishop, rook, queen)
+// weight   16 bit   how often the move should be played relative to the other moves of the position
+// learn    32 bit   unused
+//
+// The file is mapped into memory and probed by binary search, so it is never read as a whole.
+//
+// Polyglot keys xor 781 fixed random numbers (Random64 in the Polyglot sources) for the pieces, castling rights,
+// passant file (only if a pawn of the side to move can capture there) and white to move.
+//
+// Castling moves are stored as the king capturing its own rook (e1h1 for e1g1).
+
+namespace polyglot
+{
+    constexpr int RANDOM_NUMBERS_COUNT{781};
+
+    uint64_t key(const BitPosition &position);
+
+    class Book
+    {
+    public:
+        Book() = default;
+        Book(const Book &) = delete;
+        Book &operator=(const Book &) = delete;
+        ~Book() { close(); }
+
+        // Returns false if the file can't be mapped or is not a whole number of entries
+        bool open(const std::string &path);
+        void close();
+        bool isOpen() const { return m_data != nullptr; }
+
+        // Moves of the position in UCI notation with their weights, in book order
+        std::vector<std::pair<std::string, uint16_t>> moves(const BitPosition &position) const;
+        // A move picked at random with probability proportional to its weight, empty if the position is not in the book
+        std::string pickMove(const BitPosition &position) const;
+
+    private:
+        const unsigned char *m_data{nullptr};
+        size_t m_size{0};
+    };
+}
+
+#endif
@@ -1,45 +1,287 @@
 #ifndef PRECOMPUTED_MOVES_H
 #define PRECOMPUTED_MOVES_H
 
+#include <array>
 #include <cstdint> // For fixed sized integers
-#include <cstdlib> // For abs function
 
-// inline keyword is used to replace everytime there's a mention of the variable
-// with the variable definition. However the compiler can choose to not replace it,
-// since if the replacement is too big the performance might decrease at runtime.
+// The tables are computed at compile time and live in read-only memory, so there is nothing to initialize
+// at startup and lookups with known squares are folded by the compiler.
 
 namespace precomputed_moves
 {
+    using SquareTable = std::array<uint64_t, 64>;
+    using SquarePairTable = std::array<SquareTable, 64>;
+
+    // std::abs is not constexpr before C++23
+    constexpr int absolute(int value)
+    {
+        return value < 0 ? -value : value;
+    }
+
+    // Helper to check if a square is on the board
+    constexpr bool is_valid_square(int file, int rank)
+    {
+        return file >= 0 && file < 8 && rank >= 0 && rank < 8;
+    }
+
+    // Calculate knight moves
+    constexpr uint64_t calculate_knight_moves(int square)
+    {
+        uint64_t moves = 0;
+        int file = square % 8;
+        int rank = square / 8;
+
+        const int knight_offsets[8][2] = {
+            {2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}};
+
+        for (auto &offset : knight_offsets)
+        {
+            int new_file = file + offset[0];
+            int new_rank = rank + offset[1];
+            if (is_valid_square(new_file, new_rank))
+            {
+                moves |= (1ULL << (new_rank * 8 + new_file));
+            }
+        }
+
+        return moves;
+    }
+
+    // Calculate king moves
+    constexpr uint64_t calculate_king_moves(int square)
+    {
+        uint64_t moves = 0;
+        int file = square % 8;
+        int rank = square / 8;
+
+        const int king_offsets[8][2] = {
+            {1, 0}, {0, 1}, {-1, 0}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+        for (auto &offset : king_offsets)
+        {
+            int new_file = file + offset[0];
+            int new_rank = rank + offset[1];
+            if (is_valid_square(new_file, new_rank))
+            {
+                moves |= (1ULL << (new_rank * 8 + new_file));
+            }
+        }
+
+        return moves;
+    }
+
+    // Calculate pawn attack moves
+    constexpr uint64_t calculate_pawn_attacks(int square, bool is_white)
+    {
+        uint64_t attacks = 0;
+        int file = square % 8;
+        int rank = square / 8;
+
+        if (is_white && rank == 7)
+            return 0;
+        if (not is_white && rank == 0)
+            return 0;
+
+        const int offsets[2] = {
+            -1, 1 // Left and right attacks
+        };
+
+        for (auto &offset : offsets)
+        {
+            int new_file = file + offset;
+            int new_rank = rank + (is_white ? 1 : -1);
+            if (is_valid_square(new_file, new_rank))
+            {
+                attacks |= (1ULL << (new_rank * 8 + new_file));
+            }
+        }
+
+        return attacks;
+    }
+
+    // Determine the straight ray between two squares
+    constexpr uint64_t calculate_straight_between(int square1, int square2, bool include_square2)
+    {
+        int file1 = square1 % 8;
+        int rank1 = square1 / 8;
+        int file2 = square2 % 8;
+        int rank2 = square2 / 8;
+
+        int file_step = (file2 - file1) ? (file2 - file1) / absolute(file2 - file1) : 0;
+        int rank_step = (rank2 - rank1) ? (rank2 - rank1) / absolute(rank2 - rank1) : 0;
+
+        if (absolute(file2 - file1) != 0 && absolute(rank2 - rank1) != 0)
+            return 0;
+
+        uint64_t between = 0;
+        int current_file = file1 + file_step;
+        int current_rank = rank1 + rank_step;
+
+        while (current_file != file2 || current_rank != rank2)
+        {
+            between |= (1ULL << (current_rank * 8 + current_file));
+            current_file += file_step;
+            current_rank += rank_step;
+        }
+
+        if (include_square2)
+            between |= (1ULL << square2);
+
+        return between;
+    }
+
+    // Determine the diagonal ray between two squares
+    constexpr uint64_t calculate_diagonal_between(int square1, int square2, bool include_square2)
+    {
+        int file1 = square1 % 8;
+        int rank1 = square1 / 8;
+        int file2 = square2 % 8;
+        int rank2 = square2 / 8;
+
+        int file_step = (file2 - file1) ? (file2 - file1) / absolute(file2 - file1) : 0;
+        int rank_step = (rank2 - rank1) ? (rank2 - rank1) / absolute(rank2 - rank1) : 0;
+
+        if (absolute(file2 - file1) != absolute(rank2 - rank1))
+            return 0;
+
+        uint64_t between = 0;
+        int current_file = file1 + file_step;
+        int current_rank = rank1 + rank_step;
+
+        while (current_file != file2 || current_rank != rank2)
+        {
+            between |= (1ULL << (current_rank * 8 + current_file));
+            current_file += file_step;
+            current_rank += rank_step;
+        }
+
+        if (include_square2)
+            between |= (1ULL << square2);
+
+        return between;
+    }
+
+    // If the squares lie on the same diagonal or line it outputs the full line/diagonal.
+    // else 0
+    constexpr uint64_t calculate_full_between(int square1, int square2)
+    {
+        int file1 = square1 % 8;
+        int rank1 = square1 / 8;
+        int file2 = square2 % 8;
+        int rank2 = square2 / 8;
+
+        int file_diff = file2 - file1;
+        int rank_diff = rank2 - rank1;
+
+        // Determine if the squares lie on the same line or diagonal
+        if (!(file_diff == 0 || rank_diff == 0 || absolute(file_diff) == absolute(rank_diff)))
+        {
+            return 0; // Not on the same line or diagonal
+        }
+
+        int file_step = (file_diff != 0) ? file_diff / absolute(file_diff) : 0;
+        int rank_step = (rank_diff != 0) ? rank_diff / absolute(rank_diff) : 0;
+
+        if (file_step == 0 && rank_step == 0)
+            return 0;
+
+        uint64_t between = 0;
+
+        // Traverse the entire line or diagonal
+        int current_file = file1;
+        int current_rank = rank1;
+        while (is_valid_square(current_file, current_rank))
+        {
+            between |= (1ULL << (current_rank * 8 + current_file));
+            current_file += file_step;
+            current_rank += rank_step;
+        }
+
+        current_file = file1 - file_step;
+        current_rank = rank1 - rank_step;
+        while (is_valid_square(current_file, current_rank))
+        {
+            between |= (1ULL << (current_rank * 8 + current_file));
+            current_file -= file_step;
+            current_rank -= rank_step;
+        }
+
+        return between;
+    }
+
+    template <typename Function>
+    constexpr SquareTable make_square_table(Function calculate)
+    {
+        SquareTable table{};
+        for (int square = 0; square < 64; ++square)
+            table[square] = calculate(square);
+        return table;
+    }
+
+    template <typename Function>
+    constexpr SquarePairTable make_square_pair_table(Function calculate)
+    {
+        SquarePairTable table{};
+        for (int square = 0; square < 64; ++square)
+            for (int target = 0; target < 64; ++target)
+                table[square][target] = calculate(square, target);
+        return table;
+    }
+
+    // Union of the rays from square to every other square
+    template <typename Function>
+    constexpr uint64_t union_of_rays(int square, Function ray)
+    {
+        uint64_t rays = 0;
+        for (int target = 0; target < 64; ++target)
+        {
+            if (square == target)
+                continue;
+            rays |= ray(square, target);
+        }
+        return rays;
+    }
+
     // Each bit of the uint64_t represents a square of the chessboard
-    // Initialize precomputed move tables (generated using my python move generator)
-    extern uint64_t knight_moves[64];
-    extern uint64_t king_moves[64];
-    extern uint64_t pawn_attacks[2][64];
+    inline constexpr SquareTable knight_moves = make_square_table(calculate_knight_moves);
+    inline constexpr SquareTable king_moves = make_square_table(calculate_king_moves);
+    inline constexpr std::array<SquareTable, 2> pawn_attacks{
+        make_square_table([](int square) { return calculate_pawn_attacks(square, true); }),
+        make_square_table([](int square) { return calculate_pawn_attacks(square, false); })};
 
     // Moveable squares bitboard for bishop and rook without taking into account the edge squares
     // Used for computing blocker_bits given a position, used in BitPosition class
-    extern uint64_t bishop_unfull_rays[64];
-    extern uint64_t rook_unfull_rays[64];
+    inline constexpr SquareTable bishop_unfull_rays = make_square_table([](int square)
+        { return union_of_rays(square, [](int square_1, int square_2) { return calculate_diagonal_between(square_1, square_2, false); }); });
+    inline constexpr SquareTable rook_unfull_rays = make_square_table([](int square)
+        { return union_of_rays(square, [](int square_1, int square_2) { return calculate_straight_between(square_1, square_2, false); }); });
 
     // Moveable squares bitboard for bishop and rook taking into account the edge squares
     // Used for computing pin_bits in BitPosition class (setPinsBits and setChecksAndPinsBits)
-    extern uint64_t bishop_full_rays[64];
-    extern uint64_t rook_full_rays[64];
+    inline constexpr SquareTable bishop_full_rays = make_square_table([](int square)
+        { return union_of_rays(square, [](int square_1, int square_2) { return calculate_diagonal_between(square_1, square_2, true); }); });
+    inline constexpr SquareTable rook_full_rays = make_square_table([](int square)
+        { return union_of_rays(square, [](int square_1, int square_2) { return calculate_straight_between(square_1, square_2, true); }); });
 
     // Bitboards of rays from square_1 to square_2, excluding square_1 and excluding square_2
-    extern uint64_t precomputedBishopMovesTableOneBlocker[64][64];
-    extern uint64_t precomputedRookMovesTableOneBlocker[64][64];
-    extern uint64_t precomputedQueenMovesTableOneBlocker[64][64];
+    inline constexpr SquarePairTable precomputedBishopMovesTableOneBlocker = make_square_pair_table([](int square_1, int square_2)
+        { return calculate_diagonal_between(square_1, square_2, false); });
+    inline constexpr SquarePairTable precomputedRookMovesTableOneBlocker = make_square_pair_table([](int square_1, int square_2)
+        { return calculate_straight_between(square_1, square_2, false); });
+    inline constexpr SquarePairTable precomputedQueenMovesTableOneBlocker = make_square_pair_table([](int square_1, int square_2)
+        { return precomputedBishopMovesTableOneBlocker[square_1][square_2] | precomputedRookMovesTableOneBlocker[square_1][square_2]; });
 
     // Bitboards of rays from square_1 to square_2, excluding square_1 and including square_2 (for direct checks)
-    extern uint64_t precomputedBishopMovesTableOneBlocker2[64][64];
-    extern uint64_t precomputedRookMovesTableOneBlocker2[64][64];
-    extern uint64_t precomputedQueenMovesTableOneBlocker2[64][64];
+    inline constexpr SquarePairTable precomputedBishopMovesTableOneBlocker2 = make_square_pair_table([](int square_1, int square_2)
+        { return calculate_diagonal_between(square_1, square_2, true); });
+    inline constexpr SquarePairTable precomputedRookMovesTableOneBlocker2 = make_square_pair_table([](int square_1, int square_2)
+        { return calculate_straight_between(square_1, square_2, true); });
+    inline constexpr SquarePairTable precomputedQueenMovesTableOneBlocker2 = make_square_pair_table([](int square_1, int square_2)
+        { return precomputedBishopMovesTableOneBlocker2[square_1][square_2] | precomputedRookMovesTableOneBlocker2[square_1][square_2]; });
 
     // Bitboards of full line (8 squares) containing squares, otherwise 0
-    extern uint64_t OnLineBitboards[64][64];
+    inline constexpr SquarePairTable OnLineBitboards = make_square_pair_table(calculate_full_between);
 
-    void init_precomputed_moves();
     void pretty_print_all();
 }
 #endif
\ No newline at end of file
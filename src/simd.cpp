@@ -157,7 +157,7 @@ int16_t fullNnueuPass(int16_t *pInput, int8_t *pWeights11, int8_t *pWeights12, i
     // Then multiply. SSE doesn't have a single "dot-product" instruction for 8 int8s, so we do sign-extension
     // and multiply in 16 bits, then horizontal add.
     //
-    __m128i result1[8];
+    int16_t result1[8];
 
     // We will compute:
     //   output[i] = sum_{k=0..7} (input8[k] * weight1[i][k]) + bias1[i]
@@ -167,16 +167,11 @@ int16_t fullNnueuPass(int16_t *pInput, int8_t *pWeights11, int8_t *pWeights12, i
     __m128i in_8_lo = _mm_cvtepi8_epi16(packed_8);
     // now in_8_lo is 8 x int16 with the sign-extended bytes from input.
 
-    // We'll store the results in a single SSE register at the end.
-    __m128i bias1_v = _mm_loadu_si128((__m128i *)pBias1); // 8 x int16
-
     for (int i = 0; i < 8; i++)
     {
         // Load the i-th weight vector of length=8 (int8).
-        // pWeights11 + i*8 or pWeights12 + i*8 as appropriate.
-        // In your example, you have 4 from pWeights11, 4 from pWeights12, etc.
-        // We'll just show a single version (adjust logic to your layer shape).
-        __m128i w_i_8 = _mm_loadl_epi64((__m128i const *)(pWeights11 + i * 8));
+        // The first 4 neurons are in pWeights11 and the last 4 in pWeights12 (as in the NEON version).
+        __m128i w_i_8 = _mm_loadl_epi64((__m128i const *)(i < 4 ? pWeights11 + i * 8 : pWeights12 + (i - 4) * 8));
         // w_i_8 has 8 x int8 in the lower 64 bits
 
         // Sign-extend to 8 x int16
@@ -196,7 +191,7 @@ int16_t fullNnueuPass(int16_t *pInput, int8_t *pWeights11, int8_t *pWeights12, i
         int16_t dot = (int16_t)_mm_extract_epi16(sum3, 0);
 
         // Add bias
-        int16_t bias_i = ((int16_t *)&bias1_v)[i];
+        int16_t bias_i = pBias1[i];
         dot += bias_i;
 
         // Shift >> 6
@@ -206,12 +201,12 @@ int16_t fullNnueuPass(int16_t *pInput, int8_t *pWeights11, int8_t *pWeights12, i
         if (dot < 0)
             dot = 0;
 
-        // Keep it in result1[i]. We'll convert to SSE after the loop if we want a vector of these 8.
-        ((int16_t *)&result1[0])[i] = dot;
+        // Keep it in result1[i]. We'll convert to SSE after the loop.
+        result1[i] = dot;
     }
 
     // Combine the 8 results into an SSE register:
-    __m128i output1_16 = _mm_loadu_si128((__m128i *)&result1[0]);
+    __m128i output1_16 = _mm_loadu_si128((__m128i const *)result1);
 
     //
     // Next layers: exactly the same pattern
@@ -229,7 +224,6 @@ int16_t fullNnueuPass(int16_t *pInput, int8_t *pWeights11, int8_t *pWeights12, i
 
     // For layer 2, which has 4 outputs:
     int16_t out2[4];
-    __m128i bias2_v = _mm_loadl_epi64((__m128i *)pBias2); // 4 x int16 in memory
     // Each neuron = sum of 8 products + bias
     for (int i = 0; i < 4; i++)
     {
@@ -249,7 +243,7 @@ int16_t fullNnueuPass(int16_t *pInput, int8_t *pWeights11, int8_t *pWeights12, i
         int16_t dot = (int16_t)_mm_extract_epi16(sum3, 0);
 
         // add bias
-        int16_t bias_i = ((int16_t *)&bias2_v)[i];
+        int16_t bias_i = pBias2[i];
         dot += bias_i;
 
         // shift >> 6
@@ -298,4 +292,48 @@ int16_t fullNnueuPass(int16_t *pInput, int8_t *pWeights11, int8_t *pWeights12, i
 #else
 
 #endif
-}
\ No newline at end of file
+}
+////////////////
+// Move ordering
+////////////////
+
+int argmax_int32(const int32_t *values, int size)
+// Returns the index of the first maximum of values (size > 0).
+// The maximum is found with a vector scan and then located in the array.
+{
+    int32_t max_value;
+    int i = 0;
+#if defined(__ARM_NEON)
+    if (size >= 4)
+    {
+        int32x4_t max_vec = vld1q_s32(values);
+        for (i = 4; i + 4 <= size; i += 4)
+            max_vec = vmaxq_s32(max_vec, vld1q_s32(values + i));
+        max_value = vmaxvq_s32(max_vec);
+    }
+    else
+        max_value = values[i++];
+#elif defined(__SSE4_1__)
+    if (size >= 4)
+    {
+        __m128i max_vec = _mm_loadu_si128((const __m128i *)values);
+        for (i = 4; i + 4 <= size; i += 4)
+            max_vec = _mm_max_epi32(max_vec, _mm_loadu_si128((const __m128i *)(values + i)));
+        max_vec = _mm_max_epi32(max_vec, _mm_shuffle_epi32(max_vec, _MM_SHUFFLE(1, 0, 3, 2)));
+        max_vec = _mm_max_epi32(max_vec, _mm_shuffle_epi32(max_vec, _MM_SHUFFLE(2, 3, 0, 1)));
+        max_value = _mm_cvtsi128_si32(max_vec);
+    }
+    else
+        max_value = values[i++];
+#else
+    max_value = values[i++];
+#endif
+    // Remaining values
+    for (; i < size; ++i)
+        if (values[i] > max_value)
+            max_value = values[i];
+
+    for (i = 0; values[i] != max_value; ++i)
+        ;
+    return i;
+}
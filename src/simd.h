@@ -8,4 +8,5 @@ int16_t fullNnuePass(int16_t *pInput1, int16_t *pInput2, int8_t *pWeights1, int1
                      int8_t *pWeights2, int16_t *pBias2, int8_t *pWeights3, int16_t *pBias3);
 int16_t fullNnueuPass(int16_t *pInput, int8_t *pWeights11, int8_t *pWeights12, int16_t *pBias1,
                       int8_t *pWeights2, int16_t *pBias2, int8_t *pWeights3, int16_t *pBias3);
+int argmax_int32(const int32_t *values, int size);
 #endif
\ No newline at end of file
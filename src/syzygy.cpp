@@ -0,0 +1,955 @@
+#include "syzygy.h"
+#include <algorithm> // For std::min, std::max_element and std::stable_sort
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <utility> // For std::pair and std::swap
+#include <vector>
+#include <fcntl.h>    // For open
+#include <sys/mman.h> // For mmap
+#include <sys/stat.h> // For fstat
+#include <unistd.h>   // For close
+#include "bit_utils.h"
+#include "precomputed_moves.h"
+
+// The file format is the one of the Syzygy generator (https://github.com/syzygy1/tb), the reading follows the probing
+// code of Stockfish (src/syzygy/tbprobe.cpp).
+//
+// A table is split by side to move (WDL tables only, and only if the sides have different pieces) and, with pawns,
+// by the file of the leading pawn (a to d, the rest is mirrored). Each part maps positions to an index through
+// the symmetries of the board and groups of equal pieces, and stores the values of the indices compressed:
+// recursive pairing of values into symbols, then canonical Huffman codes in blocks of fixed size.
+
+namespace syzygy
+{
+    int largestTable{0};
+    int probeLimit{7};
+
+    int cardinality() { return std::min(largestTable, probeLimit); }
+    void setProbeLimit(int limit) { probeLimit = limit; }
+
+    uint64_t whiteBits(const BitPosition &position)
+    {
+        return position.getWhitePawnsBits() | position.getWhiteKnightsBits() | position.getWhiteBishopsBits() |
+               position.getWhiteRooksBits() | position.getWhiteQueensBits() | position.getWhiteKingBits();
+    }
+
+    uint64_t blackBits(const BitPosition &position)
+    {
+        return position.getBlackPawnsBits() | position.getBlackKnightsBits() | position.getBlackBishopsBits() |
+               position.getBlackRooksBits() | position.getBlackQueensBits() | position.getBlackKingBits();
+    }
+
+    int pieceCount(const BitPosition &position) { return countBits(whiteBits(position) | blackBits(position)); }
+
+    ////////////////////////////////////////////////////////////
+    // Index encoding
+    ////////////////////////////////////////////////////////////
+
+    // Pieces in the table files: 1 pawn, 2 knight, 3 bishop, 4 rook, 5 queen, 6 king (piece types plus one), plus 8
+    // for black
+    constexpr int BLACK_PIECE{8};
+    constexpr int PAWN_PIECE{1};
+    constexpr int MAX_PIECES{7};
+
+    int mapB1H1H7[64];       // Squares below the a1-h8 diagonal to 0..27
+    int mapA1D1D4[64];       // Squares of the a1-d1-d4 triangle to 0..9, the diagonal last
+    int mapKK[10][64];       // The 462 placements of two kings with the first in the triangle
+    uint64_t binomial[6][64]; // Ways to choose [k] of [n] squares
+    int mapPawns[64];        // Squares a2-h7 to 0..47, the highest for the leading pawn
+    int leadPawnIdx[6][64];  // Index of the leading pawns group by its count and leading square
+    int leadPawnsSize[6][4]; // Size of the leading pawns group by its count and leading file
+
+    // Rank minus file: negative below the a1-h8 diagonal, 0 on it
+    int offA1H8(int square) { return square / 8 - square % 8; }
+
+    // Leading pawn first: the one nearest the edge, then the lowest
+    bool pawnsCompare(int square_1, int square_2) { return mapPawns[square_1] < mapPawns[square_2]; }
+
+    void initEncoding()
+    {
+        int code{0};
+        for (int square = 0; square < 64; ++square)
+            if (offA1H8(square) < 0)
+                mapB1H1H7[square] = code++;
+
+        code = 0;
+        std::vector<int> diagonal;
+        for (int square = 0; square < 64; ++square)
+            if (square % 8 <= 3 && square / 8 <= 3 && offA1H8(square) < 0)
+                mapA1D1D4[square] = code++;
+            else if (square % 8 <= 3 && offA1H8(square) == 0)
+                diagonal.push_back(square);
+            else
+                mapA1D1D4[square] = -1;
+        for (int square : diagonal)
+            mapA1D1D4[square] = code++;
+
+        // With the first king on the diagonal the second one is not above it, and placements of both kings on the
+        // diagonal come last
+        std::vector<std::pair<int, int>> both_on_diagonal;
+        code = 0;
+        for (int index = 0; index < 10; ++index)
+            for (int square_1 = 0; square_1 < 64; ++square_1)
+            {
+                if (mapA1D1D4[square_1] != index)
+                    continue;
+                for (int square_2 = 0; square_2 < 64; ++square_2)
+                {
+                    mapKK[index][square_2] = -1;
+                    if (square_1 == square_2 || (precomputed_moves::king_moves[square_1] & (1ULL << square_2)))
+                        continue;
+                    if (offA1H8(square_1) == 0 && offA1H8(square_2) > 0)
+                        continue;
+                    if (offA1H8(square_1) == 0 && offA1H8(square_2) == 0)
+                        both_on_diagonal.emplace_back(index, square_2);
+                    else
+                        mapKK[index][square_2] = code++;
+                }
+            }
+        for (auto [index, square_2] : both_on_diagonal)
+            mapKK[index][square_2] = code++;
+
+        binomial[0][0] = 1;
+        for (int n = 1; n < 64; ++n)
+            for (int k = 0; k < 6 && k <= n; ++k)
+                binomial[k][n] = (k > 0 ? binomial[k - 1][n - 1] : 0) + (k < n ? binomial[k][n - 1] : 0);
+
+        // Any other pawn is on a lower mapPawns square than the leading one, so the leading square decides how many
+        // squares the others have (47 for a2, 45 for a3 without a2 and h2, ...)
+        int available_squares{47};
+        for (int lead_pawns_count = 1; lead_pawns_count <= 5; ++lead_pawns_count)
+            for (int file = 0; file < 4; ++file)
+            {
+                int index{0};
+                for (int rank = 1; rank <= 6; ++rank)
+                {
+                    int square{8 * rank + file};
+                    if (lead_pawns_count == 1)
+                    {
+                        mapPawns[square] = available_squares--;
+                        mapPawns[square ^ 7] = available_squares--;
+                    }
+                    leadPawnIdx[lead_pawns_count][square] = index;
+                    index += static_cast<int>(binomial[lead_pawns_count - 1][mapPawns[square]]);
+                }
+                leadPawnsSize[lead_pawns_count][file] = index;
+            }
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Tables
+    ////////////////////////////////////////////////////////////
+
+    enum TableFlags
+    {
+        STM = 1,        // Side to move of a DTZ table, 0 white
+        MAPPED = 2,     // DTZ values go through a map
+        WIN_PLIES = 4,  // DTZ values of wins are in plies, otherwise in moves
+        LOSS_PLIES = 8, // Same for losses
+        WIDE = 16,      // The DTZ map has 16 bit values
+        SINGLE_VALUE = 128
+    };
+
+    uint64_t readLittleEndian(const uint8_t *bytes, int count)
+    {
+        uint64_t value{0};
+        for (int i = count - 1; i >= 0; --i)
+            value = (value << 8) | bytes[i];
+        return value;
+    }
+
+    uint64_t readBigEndian(const uint8_t *bytes, int count)
+    {
+        uint64_t value{0};
+        for (int i = 0; i < count; ++i)
+            value = (value << 8) | bytes[i];
+        return value;
+    }
+
+    // A part of a table, for a side to move and a leading pawn file
+    struct PairsData
+    {
+        int flags{0};
+        int pieces[MAX_PIECES]{}; // In encoding order
+        int groupLen[MAX_PIECES + 1]{}; // Pieces of each group of the encoding, 0 after the last
+        uint64_t groupIdx[MAX_PIECES + 1]{}; // Factor of each group in the index, the number of indices after the last
+
+        uint64_t sizeofBlock{0};
+        uint64_t span{0}; // Indices between sparse index entries
+        uint64_t sparseIndexSize{0};
+        uint64_t blockLengthSize{0};
+        uint32_t numBlocks{0};
+        int maxSymLen{0};
+        int minSymLen{0}; // The value of every index if SINGLE_VALUE
+        std::vector<uint64_t> base64; // First code of each length, left aligned
+        std::vector<int> symLen;      // Values of each symbol minus one
+        const uint8_t *lowestSym{nullptr};   // First symbol of each length, 16 bit
+        const uint8_t *btree{nullptr};       // Symbol pairs, 12 bit left and right symbols (leaves: value and 0xFFF)
+        const uint8_t *sparseIndex{nullptr}; // Block (32 bit) and offset in it (16 bit) of every span-th index
+        const uint8_t *blockLength{nullptr}; // Values of each block minus one, 16 bit
+        const uint8_t *data{nullptr};
+        int mapIdx[4]{}; // Start of the DTZ map of each result
+
+        int leftSymbol(int sym) const { return ((btree[3 * sym + 1] & 0xF) << 8) | btree[3 * sym]; }
+        int rightSymbol(int sym) const { return (btree[3 * sym + 2] << 4) | (btree[3 * sym + 1] >> 4); }
+        int lowestSymbol(int length_index) const { return static_cast<int>(readLittleEndian(lowestSym + 2 * length_index, 2)); }
+        int blockValues(uint32_t block) const { return static_cast<int>(readLittleEndian(blockLength + 2 * block, 2)) + 1; }
+    };
+
+    struct Table
+    {
+        bool isDtz{false};
+        // Piece counts (4 bits for each piece type, white's first) with the side written first in the file name
+        // (the stronger one) as white, and with the colours swapped
+        uint64_t key{0};
+        uint64_t key2{0};
+        int pieceCount{0};
+        bool hasPawns{false};
+        bool hasUniquePieces{false}; // A piece other than a king alone of its kind and colour
+        int pawnCount[2]{};          // Leading colour first, the one with less pawns
+        const uint8_t *file{nullptr};
+        size_t fileSize{0};
+        const uint8_t *map{nullptr}; // DTZ maps
+        PairsData items[2][4];       // [side to move][leading pawn file]
+
+        Table() = default;
+        Table(const Table &) = delete;
+        Table &operator=(const Table &) = delete;
+        ~Table()
+        {
+            if (file != nullptr)
+                munmap(const_cast<uint8_t *>(file), fileSize);
+        }
+
+        PairsData &get(int stm, int leading_file) { return items[isDtz ? 0 : stm][hasPawns ? leading_file : 0]; }
+    };
+
+    std::vector<std::unique_ptr<Table>> tables;
+    std::unordered_map<uint64_t, Table *> wdlTables;
+    std::unordered_map<uint64_t, Table *> dtzTables;
+
+    uint64_t materialKey(const int counts[2][6])
+    {
+        uint64_t key{0};
+        for (int colour = 0; colour < 2; ++colour)
+            for (int piece = 0; piece < 6; ++piece)
+                key |= static_cast<uint64_t>(counts[colour][piece]) << (4 * (6 * colour + piece));
+        return key;
+    }
+
+    uint64_t materialKey(const BitPosition &position)
+    {
+        const uint64_t pieces[2][6]{{position.getWhitePawnsBits(), position.getWhiteKnightsBits(), position.getWhiteBishopsBits(),
+                                     position.getWhiteRooksBits(), position.getWhiteQueensBits(), position.getWhiteKingBits()},
+                                    {position.getBlackPawnsBits(), position.getBlackKnightsBits(), position.getBlackBishopsBits(),
+                                     position.getBlackRooksBits(), position.getBlackQueensBits(), position.getBlackKingBits()}};
+        int counts[2][6];
+        for (int colour = 0; colour < 2; ++colour)
+            for (int piece = 0; piece < 6; ++piece)
+                counts[colour][piece] = countBits(pieces[colour][piece]);
+        return materialKey(counts);
+    }
+
+    // Piece of the table files on a square
+    int pieceCode(const BitPosition &position, int square)
+    {
+        int white_piece{position.whitePieceOn(square)};
+        return white_piece != 7 ? white_piece + 1 : position.blackPieceOn(square) + 1 + BLACK_PIECE;
+    }
+
+    // Sets the groups of the encoding from the piece sequence and the order of the groups in the index
+    void setGroups(const Table &table, PairsData &d, const int order[2], int leading_file)
+    {
+        // Leading group: pawns of the leading colour, the three first pieces with unique pieces, else the kings
+        int n{0};
+        int first_length{table.hasPawns ? 0 : table.hasUniquePieces ? 3 : 2};
+        d.groupLen[n] = 1;
+        for (int i = 1; i < table.pieceCount; ++i)
+            if (--first_length > 0 || d.pieces[i] == d.pieces[i - 1])
+                d.groupLen[n]++;
+            else
+                d.groupLen[++n] = 1;
+        d.groupLen[++n] = 0;
+
+        // order[0] is the place in the index of the leading group and order[1] the one of the remaining pawns, the other
+        // groups take the rest in sequence
+        bool pawns_on_both_sides{table.hasPawns && table.pawnCount[1] > 0};
+        int next{pawns_on_both_sides ? 2 : 1};
+        int free_squares{64 - d.groupLen[0] - (pawns_on_both_sides ? d.groupLen[1] : 0)};
+        uint64_t index{1};
+        for (int k = 0; next < n || k == order[0] || k == order[1]; ++k)
+            if (k == order[0])
+            {
+                d.groupIdx[0] = index;
+                index *= table.hasPawns ? leadPawnsSize[d.groupLen[0]][leading_file] : table.hasUniquePieces ? 31332 : 462;
+            }
+            else if (k == order[1])
+            {
+                d.groupIdx[1] = index;
+                index *= binomial[d.groupLen[1]][48 - d.groupLen[0]];
+            }
+            else
+            {
+                d.groupIdx[next] = index;
+                index *= binomial[d.groupLen[next]][free_squares];
+                free_squares -= d.groupLen[next++];
+            }
+        d.groupIdx[n] = index;
+    }
+
+    int setSymLen(PairsData &d, int sym, std::vector<bool> &visited)
+    {
+        visited[sym] = true;
+        int right{d.rightSymbol(sym)};
+        if (right == 0xFFF)
+            return 0;
+        int left{d.leftSymbol(sym)};
+        if (not visited[left])
+            d.symLen[left] = setSymLen(d, left, visited);
+        if (not visited[right])
+            d.symLen[right] = setSymLen(d, right, visited);
+        return d.symLen[left] + d.symLen[right] + 1;
+    }
+
+    const uint8_t *setSizes(PairsData &d, const uint8_t *data)
+    {
+        d.flags = *data++;
+        if (d.flags & SINGLE_VALUE)
+        {
+            d.minSymLen = *data++;
+            return data;
+        }
+
+        int groups{0};
+        while (d.groupLen[groups] != 0)
+            ++groups;
+        uint64_t table_size{d.groupIdx[groups]};
+
+        d.sizeofBlock = 1ULL << *data++;
+        d.span = 1ULL << *data++;
+        d.sparseIndexSize = (table_size + d.span - 1) / d.span;
+        int padding{*data++}; // Block lengths after the last block, so that the sparse index never points past them
+        d.numBlocks = static_cast<uint32_t>(readLittleEndian(data, 4));
+        data += 4;
+        d.blockLengthSize = d.numBlocks + padding;
+        d.maxSymLen = *data++;
+        d.minSymLen = *data++;
+        d.lowestSym = data;
+
+        // Longer codes have lower values, and the symbols of a length are consecutive from lowestSym. The first code of a
+        // length is half the first free code of the next length, left aligned it is at least any longer code.
+        int lengths{d.maxSymLen - d.minSymLen + 1};
+        d.base64.assign(lengths, 0);
+        for (int i = lengths - 2; i >= 0; --i)
+            d.base64[i] = (d.base64[i + 1] + d.lowestSymbol(i) - d.lowestSymbol(i + 1)) / 2;
+        for (int i = 0; i < lengths; ++i)
+            d.base64[i] <<= 64 - i - d.minSymLen;
+        data += 2 * lengths;
+
+        d.symLen.assign(readLittleEndian(data, 2), 0);
+        data += 2;
+        d.btree = data;
+        std::vector<bool> visited(d.symLen.size());
+        for (int sym = 0; sym < static_cast<int>(d.symLen.size()); ++sym)
+            if (not visited[sym])
+                d.symLen[sym] = setSymLen(d, sym, visited);
+        return data + 3 * d.symLen.size() + (d.symLen.size() & 1);
+    }
+
+    const uint8_t *setDtzMap(Table &table, const uint8_t *data, int max_file)
+    {
+        table.map = data;
+        for (int file = 0; file <= max_file; ++file)
+        {
+            PairsData &d{table.items[0][file]};
+            if (not (d.flags & MAPPED))
+                continue;
+            // Four maps (in the order of WDL_MAP in mapScore), each a length and its values
+            if (d.flags & WIDE)
+            {
+                data += (data - table.file) & 1;
+                for (int i = 0; i < 4; ++i)
+                {
+                    d.mapIdx[i] = static_cast<int>((data - table.map) / 2 + 1);
+                    data += 2 * readLittleEndian(data, 2) + 2;
+                }
+            }
+            else
+                for (int i = 0; i < 4; ++i)
+                {
+                    d.mapIdx[i] = static_cast<int>(data - table.map + 1);
+                    data += *data + 1;
+                }
+        }
+        return data + ((data - table.file) & 1);
+    }
+
+    // Returns false if the file doesn't match the table
+    bool setTable(Table &table)
+    {
+        const uint8_t *data{table.file + 4}; // After the magic number
+        bool split{(*data & 1) != 0};
+        bool has_pawns{(*data & 2) != 0};
+        if (split != (table.key != table.key2) || has_pawns != table.hasPawns)
+            return false;
+        data++;
+
+        int sides{not table.isDtz && split ? 2 : 1};
+        int max_file{table.hasPawns ? 3 : 0};
+        bool pawns_on_both_sides{table.hasPawns && table.pawnCount[1] > 0};
+        for (int file = 0; file <= max_file; ++file)
+        {
+            // Group orders and pieces of the first side in the low nibbles, of the second one in the high nibbles
+            int order[2][2]{{*data & 0xF, pawns_on_both_sides ? data[1] & 0xF : 0xF},
+                            {*data >> 4, pawns_on_both_sides ? data[1] >> 4 : 0xF}};
+            data += 1 + pawns_on_both_sides;
+            for (int k = 0; k < table.pieceCount; ++k, ++data)
+                for (int side = 0; side < sides; ++side)
+                    table.items[side][file].pieces[k] = side ? *data >> 4 : *data & 0xF;
+            for (int side = 0; side < sides; ++side)
+                setGroups(table, table.items[side][file], order[side], file);
+        }
+        data += (data - table.file) & 1;
+
+        for (int file = 0; file <= max_file; ++file)
+            for (int side = 0; side < sides; ++side)
+                data = setSizes(table.items[side][file], data);
+        if (table.isDtz)
+            data = setDtzMap(table, data, max_file);
+        for (int file = 0; file <= max_file; ++file)
+            for (int side = 0; side < sides; ++side)
+            {
+                table.items[side][file].sparseIndex = data;
+                data += 6 * table.items[side][file].sparseIndexSize;
+            }
+        for (int file = 0; file <= max_file; ++file)
+            for (int side = 0; side < sides; ++side)
+            {
+                table.items[side][file].blockLength = data;
+                data += 2 * table.items[side][file].blockLengthSize;
+            }
+        for (int file = 0; file <= max_file; ++file)
+            for (int side = 0; side < sides; ++side)
+            {
+                data = table.file + (((data - table.file) + 63) & ~63); // 64 byte alignment
+                table.items[side][file].data = data;
+                data += table.items[side][file].numBlocks * table.items[side][file].sizeofBlock;
+            }
+        return data <= table.file + table.fileSize;
+    }
+
+    // Maps a table file given its name (KRPvKN), returns nullptr if it can't be read or isn't a table of that name
+    std::unique_ptr<Table> openTable(const std::string &path, const std::string &name, bool is_dtz)
+    {
+        auto table{std::make_unique<Table>()};
+        table->isDtz = is_dtz;
+
+        // The pieces of each side, from the name
+        int counts[2][6]{};
+        int side{0};
+        for (char piece : name)
+        {
+            size_t type{std::string("PNBRQK").find(piece)};
+            if (piece == 'v' && side == 0)
+                side = 1;
+            else if (type == std::string::npos)
+                return nullptr;
+            else
+            {
+                counts[side][type]++;
+                table->pieceCount++;
+            }
+        }
+        if (side != 1 || counts[0][5] != 1 || counts[1][5] != 1 || table->pieceCount > MAX_PIECES)
+            return nullptr;
+        int swapped[2][6];
+        for (int piece = 0; piece < 6; ++piece)
+        {
+            swapped[0][piece] = counts[1][piece];
+            swapped[1][piece] = counts[0][piece];
+            for (int colour = 0; colour < 2; ++colour)
+                if (piece < 5 && counts[colour][piece] == 1)
+                    table->hasUniquePieces = true;
+        }
+        table->key = materialKey(counts);
+        table->key2 = materialKey(swapped);
+        table->hasPawns = counts[0][0] + counts[1][0] > 0;
+        // The leading colour is the one with pawns, or with less pawns if both have them
+        bool white_leads{counts[1][0] == 0 || (counts[0][0] > 0 && counts[1][0] >= counts[0][0])};
+        table->pawnCount[0] = white_leads ? counts[0][0] : counts[1][0];
+        table->pawnCount[1] = white_leads ? counts[1][0] : counts[0][0];
+
+        int file{::open(path.c_str(), O_RDONLY)};
+        if (file < 0)
+            return nullptr;
+        struct stat file_stat;
+        // Table files end with a 16 byte checksum after data aligned to 64 bytes
+        if (fstat(file, &file_stat) != 0 || file_stat.st_size % 64 != 16)
+        {
+            ::close(file);
+            return nullptr;
+        }
+        void *data{mmap(nullptr, file_stat.st_size, PROT_READ, MAP_SHARED, file, 0)};
+        ::close(file); // The mapping stays valid
+        if (data == MAP_FAILED)
+            return nullptr;
+        table->file = static_cast<const uint8_t *>(data);
+        table->fileSize = file_stat.st_size;
+
+        constexpr uint8_t WDL_MAGIC[4]{0x71, 0xE8, 0x23, 0x5D};
+        constexpr uint8_t DTZ_MAGIC[4]{0xD7, 0x66, 0x0C, 0xA5};
+        if (not std::equal(table->file, table->file + 4, is_dtz ? DTZ_MAGIC : WDL_MAGIC) || not setTable(*table))
+            return nullptr;
+        return table;
+    }
+
+    int init(const std::string &path)
+    {
+        static bool encoding_initialized{false};
+        if (not encoding_initialized)
+        {
+            initEncoding();
+            encoding_initialized = true;
+        }
+        wdlTables.clear();
+        dtzTables.clear();
+        tables.clear();
+        largestTable = 0;
+        if (path.empty() || path == "<empty>")
+            return largestTable;
+
+        size_t start{0};
+        while (start <= path.size())
+        {
+            size_t end{std::min(path.find(':', start), path.size())};
+            // Missing or unreadable directories are skipped (the error_code overloads don't throw)
+            std::error_code error;
+            for (std::filesystem::directory_iterator entry(path.substr(start, end - start), error), last;
+                 not error && entry != last; entry.increment(error))
+            {
+                std::string extension{entry->path().extension().string()};
+                if (extension != ".rtbw" && extension != ".rtbz")
+                    continue;
+                bool is_dtz{extension == ".rtbz"};
+                std::unique_ptr<Table> table{openTable(entry->path().string(), entry->path().stem().string(), is_dtz)};
+                // A table found in an earlier directory is kept
+                auto &by_key{is_dtz ? dtzTables : wdlTables};
+                if (table == nullptr || by_key.count(table->key) != 0)
+                    continue;
+                by_key[table->key] = table.get();
+                by_key[table->key2] = table.get();
+                if (not is_dtz)
+                    largestTable = std::max(largestTable, table->pieceCount);
+                tables.push_back(std::move(table));
+            }
+            start = end + 1;
+        }
+        return largestTable;
+    }
+
+    ////////////////////////////////////////////////////////////
+    // Probing
+    ////////////////////////////////////////////////////////////
+
+    enum ProbeState
+    {
+        FAIL,
+        OK,
+        CHANGE_STM,       // The DTZ table holds the other side to move
+        ZEROING_BEST_MOVE // The best move is a capture or pawn move, whose value the DTZ table doesn't hold
+    };
+
+    // Value of an index of a part of a table
+    int decompressPairs(const PairsData &d, uint64_t index)
+    {
+        if (d.flags & SINGLE_VALUE)
+            return d.minSymLen;
+
+        // Every span-th index (from the middle of the first span) has its block and its offset in the block in the
+        // sparse index, the index's block is found from the nearest one
+        uint64_t k{index / d.span};
+        uint32_t block{static_cast<uint32_t>(readLittleEndian(d.sparseIndex + 6 * k, 4))};
+        int offset{static_cast<int>(readLittleEndian(d.sparseIndex + 6 * k + 4, 2))};
+        offset += static_cast<int>(index % d.span) - static_cast<int>(d.span / 2);
+        while (offset < 0)
+            offset += d.blockValues(--block);
+        while (offset >= d.blockValues(block))
+            offset -= d.blockValues(block++);
+
+        // Symbols from the start of the block until the one holding the offset. The code length is the first one whose
+        // first code the bits reach.
+        const uint8_t *bytes{d.data + block * d.sizeofBlock};
+        uint64_t buffer{readBigEndian(bytes, 8)};
+        bytes += 8;
+        int buffer_size{64};
+        int sym;
+        while (true)
+        {
+            int length{0};
+            while (buffer < d.base64[length])
+                ++length;
+            sym = static_cast<int>((buffer - d.base64[length]) >> (64 - length - d.minSymLen)) + d.lowestSymbol(length);
+            if (offset <= d.symLen[sym])
+                break;
+            offset -= d.symLen[sym] + 1;
+            length += d.minSymLen;
+            buffer <<= length;
+            buffer_size -= length;
+            if (buffer_size <= 32)
+            {
+                buffer_size += 32;
+                buffer |= readBigEndian(bytes, 4) << (64 - buffer_size);
+                bytes += 4;
+            }
+        }
+
+        // Down the pairs of the symbol to the value at the offset
+        while (d.symLen[sym] != 0)
+        {
+            int left{d.leftSymbol(sym)};
+            if (offset <= d.symLen[left])
+                sym = left;
+            else
+            {
+                offset -= d.symLen[left] + 1;
+                sym = d.rightSymbol(sym);
+            }
+        }
+        return d.leftSymbol(sym);
+    }
+
+    // Distance to zeroing in plies of a DTZ table value
+    int mapScore(Table &table, int leading_file, int value, Wdl wdl)
+    {
+        constexpr int WDL_MAP[]{1, 3, 0, 2, 0};
+        const PairsData &d{table.get(0, leading_file)};
+        if (d.flags & MAPPED)
+        {
+            int index{d.mapIdx[WDL_MAP[wdl + 2]] + value};
+            value = d.flags & WIDE ? static_cast<int>(readLittleEndian(table.map + 2 * index, 2)) : table.map[index];
+        }
+        if ((wdl == WIN && not (d.flags & WIN_PLIES)) || (wdl == LOSS && not (d.flags & LOSS_PLIES)) ||
+            wdl == CURSED_WIN || wdl == BLESSED_LOSS)
+            value *= 2;
+        return value + 1;
+    }
+
+    // The table value of the position: its result for WDL tables, the distance to zeroing of a position with result wdl
+    // for DTZ tables (with state CHANGE_STM if the table holds the other side to move)
+    int probeTable(BitPosition &position, bool is_dtz, Wdl wdl, ProbeState &state)
+    {
+        if (pieceCount(position) == 2) // Kings only
+            return 0;
+        auto &by_key{is_dtz ? dtzTables : wdlTables};
+        auto found{by_key.find(materialKey(position))};
+        if (found == by_key.end())
+        {
+            state = FAIL;
+            return 0;
+        }
+        Table &table{*found->second};
+
+        // Tables have the stronger side as white, and if both sides have the same pieces only white to move. Otherwise
+        // colours are swapped and the board flipped vertically.
+        bool symmetric_black_to_move{table.key == table.key2 && not position.getTurn()};
+        bool flip{symmetric_black_to_move || materialKey(position) != table.key};
+        int flip_colour{flip ? BLACK_PIECE : 0};
+        int flip_squares{flip ? 56 : 0};
+        int stm{flip == position.getTurn()}; // 0 if white of the table is to move
+
+        // Leading pawns first, with the leading one (the highest mapPawns) at the front. Its file decides the part of
+        // the table, e to h are mirrored to d to a.
+        int squares[MAX_PIECES];
+        int pieces[MAX_PIECES];
+        int size{0};
+        int lead_pawns_count{0};
+        uint64_t lead_pawns{0};
+        int leading_file{0};
+        if (table.hasPawns)
+        {
+            int pawn{table.get(0, 0).pieces[0] ^ flip_colour};
+            lead_pawns = (pawn & BLACK_PIECE) ? position.getBlackPawnsBits() : position.getWhitePawnsBits();
+            for (uint64_t pawns = lead_pawns; pawns != 0;)
+                squares[size++] = popLeastSignificantBit(pawns) ^ flip_squares;
+            lead_pawns_count = size;
+            std::swap(squares[0], *std::max_element(squares, squares + lead_pawns_count, pawnsCompare));
+            leading_file = squares[0] % 8 > 3 ? 7 - squares[0] % 8 : squares[0] % 8;
+        }
+
+        if (is_dtz && (table.get(0, leading_file).flags & STM) != stm && (table.key != table.key2 || table.hasPawns))
+        {
+            state = CHANGE_STM;
+            return 0;
+        }
+
+        for (uint64_t others = (whiteBits(position) | blackBits(position)) ^ lead_pawns; others != 0;)
+        {
+            int square{popLeastSignificantBit(others)};
+            squares[size] = square ^ flip_squares;
+            pieces[size++] = pieceCode(position, square) ^ flip_colour;
+        }
+
+        // Pieces in the sequence of the table
+        PairsData &d{table.get(stm, leading_file)};
+        for (int i = lead_pawns_count; i < size - 1; ++i)
+            for (int j = i + 1; j < size; ++j)
+                if (d.pieces[i] == pieces[j])
+                {
+                    std::swap(pieces[i], pieces[j]);
+                    std::swap(squares[i], squares[j]);
+                    break;
+                }
+
+        // The leading piece to files a to d
+        if (squares[0] % 8 > 3)
+            for (int i = 0; i < size; ++i)
+                squares[i] ^= 7;
+
+        uint64_t index;
+        if (table.hasPawns)
+        {
+            // The other leading pawns by increasing mapPawns
+            index = leadPawnIdx[lead_pawns_count][squares[0]];
+            std::stable_sort(squares + 1, squares + lead_pawns_count, pawnsCompare);
+            for (int i = 1; i < lead_pawns_count; ++i)
+                index += binomial[i][mapPawns[squares[i]]];
+        }
+        else
+        {
+            // The leading piece to ranks 1 to 4, then the first piece of the leading group off the a1-h8 diagonal below it
+            if (squares[0] / 8 > 3)
+                for (int i = 0; i < size; ++i)
+                    squares[i] ^= 56;
+            for (int i = 0; i < d.groupLen[0]; ++i)
+            {
+                if (offA1H8(squares[i]) == 0)
+                    continue;
+                if (offA1H8(squares[i]) > 0)
+                    for (int j = i; j < size; ++j)
+                        squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+                break;
+            }
+
+            if (table.hasUniquePieces)
+            {
+                // Three pieces: the first in the triangle, the others on the squares left. Placements with pieces on the
+                // diagonal come after, by the number of pieces on it.
+                int adjust_1{squares[1] > squares[0]};
+                int adjust_2{(squares[2] > squares[0]) + (squares[2] > squares[1])};
+                if (offA1H8(squares[0]) != 0)
+                    index = (mapA1D1D4[squares[0]] * 63 + (squares[1] - adjust_1)) * 62 + squares[2] - adjust_2;
+                else if (offA1H8(squares[1]) != 0)
+                    index = (6 * 63 + (squares[0] / 8) * 28 + mapB1H1H7[squares[1]]) * 62 + squares[2] - adjust_2;
+                else if (offA1H8(squares[2]) != 0)
+                    index = 6 * 63 * 62 + 4 * 28 * 62 + (squares[0] / 8) * 7 * 28 + (squares[1] / 8 - adjust_1) * 28 +
+                            mapB1H1H7[squares[2]];
+                else
+                    index = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + (squares[0] / 8) * 7 * 6 +
+                            (squares[1] / 8 - adjust_1) * 6 + (squares[2] / 8 - adjust_2);
+            }
+            else
+                index = mapKK[mapA1D1D4[squares[0]]][squares[1]];
+        }
+
+        // The other groups, each as a combination of the squares not taken by the groups before it (the remaining pawns
+        // off the first rank)
+        index *= d.groupIdx[0];
+        int *group_squares{squares + d.groupLen[0]};
+        bool remaining_pawns{table.hasPawns && table.pawnCount[1] > 0};
+        for (int next = 1; d.groupLen[next] != 0; ++next)
+        {
+            std::stable_sort(group_squares, group_squares + d.groupLen[next]);
+            uint64_t group_index{0};
+            for (int i = 0; i < d.groupLen[next]; ++i)
+            {
+                int adjust{static_cast<int>(std::count_if(squares, group_squares, [&](int square) { return group_squares[i] > square; }))};
+                group_index += binomial[i + 1][group_squares[i] - adjust - 8 * remaining_pawns];
+            }
+            remaining_pawns = false;
+            index += group_index * d.groupIdx[next];
+            group_squares += d.groupLen[next];
+        }
+
+        int value{decompressPairs(d, index)};
+        return is_dtz ? mapScore(table, leading_file, value, wdl) : value - 2;
+    }
+
+    MoveList<MAX_MOVES> legalMoves(BitPosition &position)
+    {
+        position.setIsCheckOnInitialization();
+        return position.getIsCheck() ? position.inCheckAllMoves() : position.allMoves();
+    }
+
+    bool isPawnMove(const BitPosition &position, Move move)
+    {
+        int origin{move.getOriginSquare()};
+        return (position.getTurn() ? position.whitePieceOn(origin) : position.blackPieceOn(origin)) == 0;
+    }
+
+    bool isCapture(const BitPosition &position, Move move)
+    {
+        int destination{move.getDestinationSquare()};
+        if ((position.getTurn() ? position.blackPieceOn(destination) : position.whitePieceOn(destination)) != 7)
+            return true;
+        // A pawn can only reach the passant square by capturing
+        return position.getPassantSquare() != 0 && destination == position.getPassantSquare() && isPawnMove(position, move);
+    }
+
+    // Result of the side to move, from the captures (and pawn moves if check_zeroing_moves) and the WDL table.
+    // Tables have no passant squares, so captures must be searched. The state is ZEROING_BEST_MOVE if a capture
+    // (or pawn move) is at least as good as the table value, DTZ tables don't hold those positions.
+    Wdl search(BitPosition &position, bool check_zeroing_moves, ProbeState &state)
+    {
+        Wdl best_value{LOSS};
+        StateInfo state_info;
+        MoveList<MAX_MOVES> moves{legalMoves(position)};
+        int moves_searched{0};
+        for (Move move : moves)
+        {
+            if (not isCapture(position, move) && (not check_zeroing_moves || not isPawnMove(position, move)))
+                continue;
+            moves_searched++;
+            position.makeMove(move, state_info);
+            Wdl value{static_cast<Wdl>(-search(position, false, state))};
+            position.unmakeMove(move);
+            if (state == FAIL)
+                return DRAW;
+            if (value > best_value)
+            {
+                best_value = value;
+                if (value >= WIN)
+                {
+                    state = ZEROING_BEST_MOVE;
+                    return value;
+                }
+            }
+        }
+
+        // With every move searched the table isn't needed (and could be wrong if passant is possible)
+        bool no_more_moves{moves_searched != 0 && moves_searched == moves.size()};
+        Wdl value{best_value};
+        if (not no_more_moves)
+        {
+            value = static_cast<Wdl>(probeTable(position, false, DRAW, state));
+            if (state == FAIL)
+                return DRAW;
+        }
+        if (best_value >= value)
+        {
+            state = best_value > DRAW || no_more_moves ? ZEROING_BEST_MOVE : OK;
+            return best_value;
+        }
+        state = OK;
+        return value;
+    }
+
+    int sign(int value) { return (value > 0) - (value < 0); }
+
+    // Distance to zeroing of the position before a zeroing move with result wdl (100 more under the 50 move rule)
+    int dtzBeforeZeroing(Wdl wdl)
+    {
+        return wdl == WIN ? 1 : wdl == CURSED_WIN ? 101 : wdl == BLESSED_LOSS ? -101 : wdl == LOSS ? -1 : 0;
+    }
+
+    // Plies to the next capture or pawn move (or checkmate) with the best play, positive if the side to move wins,
+    // negative if it loses, 0 for draws. May be one more than the real distance when the table stores moves.
+    int probeDtz(BitPosition &position, ProbeState &state)
+    {
+        state = OK;
+        Wdl wdl{search(position, true, state)};
+        if (state == FAIL || wdl == DRAW)
+            return 0;
+        if (state == ZEROING_BEST_MOVE)
+            return dtzBeforeZeroing(wdl);
+
+        int dtz{probeTable(position, true, wdl, state)};
+        if (state == FAIL)
+            return 0;
+        if (state != CHANGE_STM)
+            return (dtz + 100 * (wdl == BLESSED_LOSS || wdl == CURSED_WIN)) * sign(wdl);
+
+        // The table holds the other side to move: the best distance after each move, plus one
+        StateInfo state_info;
+        int min_dtz{0xFFFF};
+        for (Move move : legalMoves(position))
+        {
+            bool zeroing{isCapture(position, move) || isPawnMove(position, move)};
+            position.makeMove(move, state_info);
+            // The distance before a zeroing move comes from the result after it
+            dtz = zeroing ? -dtzBeforeZeroing(search(position, false, state)) : -probeDtz(position, state);
+            if (dtz == 1 && legalMoves(position).size() == 0 && position.getIsCheck())
+                min_dtz = 1; // Checkmate
+            if (not zeroing)
+                dtz += sign(dtz);
+            // Only moves keeping the result, the shortest when winning, the longest when losing
+            if (dtz < min_dtz && sign(dtz) == sign(wdl))
+                min_dtz = dtz;
+            position.unmakeMove(move);
+            if (state == FAIL)
+                return 0;
+        }
+        return min_dtz == 0xFFFF ? -1 : min_dtz;
+    }
+
+    bool probeWdl(BitPosition &position, Wdl &wdl)
+    {
+        if (position.getCastlingRights() != 0 || pieceCount(position) > cardinality())
+            return false;
+        ProbeState state{OK};
+        wdl = search(position, false, state);
+        return state != FAIL;
+    }
+
+    bool probeRoot(BitPosition &position, Move &move, Wdl &wdl)
+    {
+        if (position.getCastlingRights() != 0 || pieceCount(position) > cardinality())
+            return false;
+
+        // Distance to zeroing of each move counted from the root. A win is kept under the 50 move rule if the zeroing
+        // move comes before the count reaches 100 (with a ply to spare, as distances in moves may be one too many).
+        int fifty_move_count{position.getReversibleMovesMade()};
+        int best_dtz{0};
+        bool found{false};
+        StateInfo state_info;
+        for (Move root_move : legalMoves(position))
+        {
+            ProbeState state{OK};
+            position.makeMove(root_move, state_info);
+            int dtz;
+            if (position.getReversibleMovesMade() == 0)
+                dtz = dtzBeforeZeroing(static_cast<Wdl>(-search(position, false, state)));
+            else if (position.isDraw()) // Repetition or 50 moves
+                dtz = 0;
+            else
+            {
+                dtz = -probeDtz(position, state);
+                dtz += sign(dtz);
+            }
+            if (dtz == 2 && legalMoves(position).size() == 0 && position.getIsCheck())
+                dtz = 1; // Checkmate
+            position.unmakeMove(root_move);
+            if (state == FAIL)
+                return false;
+
+            // Wins before draws before losses, the shortest win and the longest loss
+            auto rank{[](int distance) { return distance > 0 ? 0x10000 - distance : distance < 0 ? -0x10000 - distance : 0; }};
+            if (not found || rank(dtz) > rank(best_dtz))
+            {
+                found = true;
+                best_dtz = dtz;
+                move = root_move;
+            }
+        }
+        if (not found)
+            return false;
+
+        if (best_dtz > 0)
+            wdl = best_dtz + fifty_move_count <= 99 ? WIN : CURSED_WIN;
+        else if (best_dtz < 0)
+            wdl = -best_dtz + fifty_move_count <= 99 ? LOSS : BLESSED_LOSS;
+        else
+            wdl = DRAW;
+        return true;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef SYZYGY_H
+#define SYZYGY_H
+
+#include <string>
+#include "bitposition.h"
+#include "move.h"
+
+// Syzygy endgame tablebases.
+//
+// The table files (KQvKR.rtbw, KQvKR.rtbz, ...) are mapped into memory when the path is set and decompressed on
+// each probe, so only the pages that are probed are ever read.
+//
+// + WDL tables give win/draw/loss of the side to move. They are probed in the search, only right after a capture
+//   or pawn move (the 50 move counter at 0) and without castling rights.
+// + DTZ tables give the distance to the next capture or pawn move. They are probed at the root to pick a move that
+//   keeps the best result and makes progress towards it under the 50 move rule.
+//
+// Neither table holds passant squares, and a DTZ table holds only one side to move, so probes also make captures
+// (and at the root every move) to get the values the tables don't have.
+
+namespace syzygy
+{
+    // Result for the side to move. Cursed wins and blessed losses are wins and losses that the 50 move rule makes draws.
+    enum Wdl
+    {
+        LOSS = -2,
+        BLESSED_LOSS = -1,
+        DRAW = 0,
+        CURSED_WIN = 1,
+        WIN = 2
+    };
+
+    // Maps the tables of the directories in path (separated by ':'), unmapping the previous ones.
+    // Returns the largest number of pieces of the tables found, 0 if none (which disables probing).
+    int init(const std::string &path);
+    // Largest number of pieces that can be probed, also limited by the SyzygyProbeLimit option
+    int cardinality();
+    void setProbeLimit(int limit);
+
+    int pieceCount(const BitPosition &position);
+
+    // Both return false if the position is not in the tables (or can't be probed). Moves are made and unmade on the
+    // position, which is left as it was.
+    bool probeWdl(BitPosition &position, Wdl &wdl);
+    // The move that keeps the best result, the fastest to its next capture or pawn move when winning
+    bool probeRoot(BitPosition &position, Move &move, Wdl &wdl);
+}
+
+#endif
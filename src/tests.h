@@ -3,6 +3,9 @@
 #include "bitposition.h"
 #include "move_selectors.h"
 #include "ttable.h"
+#include <atomic>
+#include <memory> // For std::unique_ptr
+#include <thread>
 #include <vector>
 #include <iostream> // For printing
 
@@ -30,7 +33,7 @@ unsigned long long runFirstMovesPerftTest(BitPosition &position, int depth, int
     if (position.getIsCheck()) // In check first moves
     {
         // All moves
-        std::vector<Move> first_moves = position.inCheckAllMoves();
+        MoveList<MAX_MOVES> first_moves = position.inCheckAllMoves();
         for (Move move : first_moves)
         {
             if (currentDepth == 0)
@@ -54,7 +57,7 @@ unsigned long long runFirstMovesPerftTest(BitPosition &position, int depth, int
     else // Not in check first moves
     {
         // All moves
-        std::vector<Move> first_moves = position.allMoves();
+        MoveList<MAX_MOVES> first_moves = position.allMoves();
         for (Move move : first_moves)
         {
             if (currentDepth == 0)
@@ -315,7 +318,99 @@ unsigned long long runPVPerftTest(BitPosition &position, int depth, int currentD
     // if (position.getZobristKey() == 10095184848992382700)
     //     std::cout << "klk\n";
     // Saving a tt value
-    globalTT.save(position.getZobristKey(), 0, depth, lastMove, false);
+    globalTT.save(position.getZobristKey(), 0, depth, lastMove, BOUND_NONE);
+    return moveCount;
+}
+
+unsigned long long runStagedPerftTest(BitPosition &position, int depth, int currentDepth = 0)
+// Function to test the staged move generation of ABMoveSelectorNotCheck::next_move, where the tt move
+// (the last move of the previous iteration) is skipped by every stage
+{
+    if (depth == 0)
+        return 1;
+    unsigned long long moveCount = 0;
+    Move lastMove = Move(0); // For ttTable
+    position.setBlockersAndPinsInAB(); // For discovered checks and move generators
+    position.setCheckBits();
+    // TTmove
+    Move tt_move = Move(0);
+    TTEntry *ttEntry = globalTT.probe(position.getZobristKey());
+    StateInfo state_info;
+    // If position is stored in ttable
+    if (ttEntry != nullptr)
+        tt_move = ttEntry->getMove();
+    if (tt_move.getData() != 0 && position.ttMoveIsOk(tt_move))
+    {
+        if (currentDepth == 0)
+        {
+            printMove(tt_move);
+        }
+        position.makeMove(tt_move, state_info);
+
+        unsigned long long subCount = runStagedPerftTest(position, depth - 1, currentDepth + 1);
+
+        position.unmakeMove(tt_move);
+
+        if (currentDepth == 0)
+        {
+            std::cout << subCount << std::endl; // Print the number of moves leading from this move
+        }
+        moveCount += subCount;
+    }
+
+    if (position.getIsCheck()) // In check moves
+    {
+        position.setCheckInfo();
+        Move move;
+        ABMoveSelectorCheck move_selector(position, tt_move);
+        move_selector.init();
+        while ((move = move_selector.select_legal()) != Move(0))
+        {
+            if (currentDepth == 0)
+            {
+                printMove(move);
+            }
+            position.makeMove(move, state_info);
+
+            unsigned long long subCount = runStagedPerftTest(position, depth - 1, currentDepth + 1);
+
+            position.unmakeMove(move);
+
+            if (currentDepth == 0)
+            {
+                std::cout << subCount << std::endl; // Print the number of moves leading from this move
+            }
+
+            moveCount += subCount;
+        }
+    }
+    else // Not in check
+    {
+        Move move;
+        ABMoveSelectorNotCheck move_selector(position, tt_move);
+        while ((move = move_selector.next_move()) != Move(0))
+        {
+            lastMove = move;
+            if (currentDepth == 0)
+            {
+                printMove(move);
+            }
+            position.makeMove(move, state_info);
+
+            unsigned long long subCount = runStagedPerftTest(position, depth - 1, currentDepth + 1);
+
+            position.unmakeMove(move);
+
+            if (currentDepth == 0)
+            {
+                std::cout << subCount << std::endl; // Print the number of moves leading from this move
+            }
+
+            moveCount += subCount;
+        }
+    }
+    // Saving a tt value
+    globalTT.save(position.getZobristKey(), 0, depth, lastMove, BOUND_NONE);
     return moveCount;
 }
 
@@ -449,7 +544,227 @@ unsigned long long runNonPVPerftTest(BitPosition &position, int depth, int curre
         }
     }
     // Saving a tt value
-    globalTT.save(position.getZobristKey(), 0, depth, lastMove, false);
+    globalTT.save(position.getZobristKey(), 0, depth, lastMove, BOUND_NONE);
     return moveCount;
 }
+
+// Perft results of already counted positions, keyed by zobrist key and depth.
+// It is shared by all perft threads without locks: an entry holds its nodes and key ^ nodes,
+// so an entry torn by two threads writing at once does not match any key.
+class PerftTable
+{
+private:
+    struct Entry
+    {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> nodes{0};
+    };
+    std::unique_ptr<Entry[]> m_entries;
+    uint64_t m_mask{0};
+
+    static uint64_t depthKey(uint64_t zobrist_key, int depth) { return zobrist_key ^ (depth * 0x9E3779B97F4A7C15ULL); }
+
+public:
+    // Size in megabytes, rounded down to a power of two number of entries
+    explicit PerftTable(int megabytes)
+    {
+        uint64_t entries{1};
+        while (entries * 2 * sizeof(Entry) <= static_cast<uint64_t>(megabytes) << 20)
+            entries *= 2;
+        m_entries = std::make_unique<Entry[]>(entries);
+        m_mask = entries - 1;
+    }
+
+    bool probe(uint64_t zobrist_key, int depth, unsigned long long &nodes) const
+    {
+        uint64_t key{depthKey(zobrist_key, depth)};
+        const Entry &entry{m_entries[key & m_mask]};
+        uint64_t entry_nodes{entry.nodes.load(std::memory_order_relaxed)};
+        if ((entry.check.load(std::memory_order_relaxed) ^ entry_nodes) != key)
+            return false;
+        nodes = entry_nodes;
+        return true;
+    }
+
+    void save(uint64_t zobrist_key, int depth, unsigned long long nodes)
+    {
+        uint64_t key{depthKey(zobrist_key, depth)};
+        Entry &entry{m_entries[key & m_mask]};
+        entry.check.store(key ^ nodes, std::memory_order_relaxed);
+        entry.nodes.store(nodes, std::memory_order_relaxed);
+    }
+};
+
+unsigned long long perft(BitPosition &position, int depth, PerftTable *table)
+// Counts leaf nodes using the legal move generators: at depth 1 the number of legal moves is returned
+// without making them (bulk counting). Results for depth >= 2 are stored in table if there is one.
+{
+    if (depth == 0)
+        return 1;
+    position.setIsCheckOnInitialization();
+    MoveList<MAX_MOVES> moves{position.getIsCheck() ? position.inCheckAllMoves() : position.allMoves()};
+    if (depth == 1)
+        return moves.size();
+
+    unsigned long long moveCount{0};
+    if (table != nullptr && table->probe(position.getZobristKey(), depth, moveCount))
+        return moveCount;
+
+    StateInfo state_info;
+    for (Move move : moves)
+    {
+        position.makeMove(move, state_info);
+        moveCount += perft(position, depth - 1, table);
+        position.unmakeMove(move);
+    }
+
+    if (table != nullptr)
+        table->save(position.getZobristKey(), depth, moveCount);
+    return moveCount;
+}
+
+unsigned long long perftCopyMake(BitPosition &position, int depth)
+// Same as perft without a table, but moves are taken back by restoring a snapshot of the board (copy-make)
+{
+    if (depth == 0)
+        return 1;
+    position.setIsCheckOnInitialization();
+    MoveList<MAX_MOVES> moves{position.getIsCheck() ? position.inCheckAllMoves() : position.allMoves()};
+    if (depth == 1)
+        return moves.size();
+
+    unsigned long long moveCount{0};
+    const BoardSnapshot snapshot{position.takeSnapshot()};
+    StateInfo state_info;
+    for (Move move : moves)
+    {
+        position.makeMove(move, state_info);
+        moveCount += perftCopyMake(position, depth - 1);
+        position.restoreSnapshot(snapshot, move);
+    }
+    return moveCount;
+}
+
+unsigned long long runPerft(BitPosition &position, int depth, int threads, int hash_megabytes, bool print_moves = true)
+// Perft with the root moves split between threads. Each thread takes the next unsearched root move
+// and counts it on its own copy of the position. Prints the number of nodes after each root move if print_moves.
+{
+    position.setIsCheckOnInitialization();
+    MoveList<MAX_MOVES> root_moves{position.getIsCheck() ? position.inCheckAllMoves() : position.allMoves()};
+    if (depth <= 1)
+    {
+        if (print_moves)
+            for (Move move : root_moves)
+                std::cout << move.toString() << ": 1\n";
+        return depth == 1 ? root_moves.size() : 1;
+    }
+
+    std::unique_ptr<PerftTable> table;
+    if (hash_megabytes > 0)
+        table = std::make_unique<PerftTable>(hash_megabytes);
+
+    std::vector<unsigned long long> root_counts(root_moves.size());
+    std::atomic<int> next_move{0};
+    auto worker = [&]()
+    {
+        BitPosition thread_position{position};
+        StateInfo root_state_info;
+        thread_position.detachStateInfo(root_state_info);
+        StateInfo state_info;
+        for (int i = next_move++; i < root_moves.size(); i = next_move++)
+        {
+            thread_position.makeMove(root_moves[i], state_info);
+            root_counts[i] = perft(thread_position, depth - 1, table.get());
+            thread_position.unmakeMove(root_moves[i]);
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (int i = 1; i < std::min<int>(threads, root_moves.size()); ++i)
+        helpers.emplace_back(worker);
+    worker();
+    for (std::thread &helper : helpers)
+        helper.join();
+
+    unsigned long long moveCount{0};
+    for (int i = 0; i < root_moves.size(); ++i)
+    {
+        if (print_moves)
+            std::cout << root_moves[i].toString() << ": " << root_counts[i] << "\n";
+        moveCount += root_counts[i];
+    }
+    return moveCount;
+}
+
+// Standard perft positions with their expected node counts, used by the perftSuite command
+struct PerftSuiteEntry
+{
+    const char *fen;
+    int depth;
+    unsigned long long nodes;
+};
+constexpr PerftSuiteEntry PERFT_SUITE[]{
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 6, 119060324ULL},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5, 193690690ULL},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 7, 178633661ULL},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5, 15833292ULL},
+    {"r2q1rk1/pP1p2pp/Q4n2/bbp1p3/Np6/1B3NBn/pPPP1PPP/R3K2R b KQ - 0 1", 5, 15833292ULL},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5, 89941194ULL},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5, 164075551ULL},
+};
+
+// Positions searched by the bench command: openings, middlegames and endgames (none of them finished games)
+constexpr const char *BENCH_POSITIONS[]{
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+    "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+    "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+    "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+    "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+    "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+    "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+    "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+    "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+    "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+    "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+    "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 3 54",
+    "3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
+    "2K5/p7/7P/5pR1/8/5k2/r7/8 w - - 0 1",
+    "8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+    "7k/3p2pp/4q3/8/4Q3/5Kp1/P6b/8 w - - 0 1",
+    "8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+    "8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+    "8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
+    "8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
+    "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+    "6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
+    "1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
+    "6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+    "8/3p3B/5p2/5P2/p7/PP5b/k7/6K1 w - - 0 1",
+    "5rk1/q6p/2p3bR/1pPp1rP1/1P1Pp3/P3B1Q1/1K3P2/R7 w - - 93 90",
+    "4rrk1/1p1nq3/p7/2p1P1pp/3P2bp/3Q1Bn1/PPPB4/1K2R1NR w - - 40 21",
+    "r3k2r/3nnpbp/q2pp1p1/p7/Pp1PPPP1/4BNN1/1P5P/R2Q1RK1 w kq - 0 16",
+    "3Qb1k1/1r2ppb1/pN1n2q1/Pp1Pp1Pr/4P2p/4BP2/4B1R1/1R5K b - - 11 40",
+    "4k3/3q1r2/1N2r1b1/3ppN2/2nPP3/1B1R2n1/2R1Q3/3K4 w - - 5 1",
+    "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+    "8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+    "8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+    "8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+    "8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+    "8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+    "8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+    "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+    "r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "1b1q4/8/P2p4/1N1Pp2p/5P1k/7P/1B1P3K/8 w - - 0 1",
+    "2r2rk1/1b3ppp/p1qpp3/1P6/1Pn1P2b/2NB1P1P/1BP1R1P1/R2Q2K1 b - - 0 19",
+    "rn2kb1r/1bq2pp1/pp3n1p/4p3/2PQ1B1P/2N3P1/PP2PPB1/2KR3R w kq - 0 12",
+    "3k2rr/4b3/p3Qpq1/P2pn3/1p1Nb3/6B1/1PP1B2P/3R1RK1 b - - 0 25",
+};
 #endif
@@ -3,20 +3,21 @@
 #include "move.h"
 #include <vector>
 #include <cstring> // For std::memset
+#include <algorithm> // For std::min
 
 // The transposition table will store the zobrist keys of seen positions, the depth reached starting from that position, the
 // best move found, the value found and the value type.
 // 
-// Value types can either be exact (no cutoff produced when the position was searched previously), 
-// lower bounds (a beta cutoof was done when searching this position previously), or upper bounds
-// (a alpha cutoff was done when searching this position previously).
+// Value types can either be exact (the value fell inside the search window), lower bounds (the value was at or above
+// beta, the real value can be higher) or upper bounds (the value was at or below alpha, the real value can be lower).
+// Values are from the engine's perspective, as in the search, so they don't depend on whose turn it is.
 
 // If in the algorithm we reach a position which is in the transposition table:
 // + If the depth  is more than the one in the table, we return the best move found previously to start searching on that move.
 // + If the depth we are going to search (from the position) is less or equal than the one in the table. We have three options:
 //  - If the valueType is exact, return value and dont search anymore.
-//  - If valueType is a lower bound,
-//  - If valueType is a upper bound, 
+//  - If valueType is a lower bound, return it if it is at or above beta, otherwise raise alpha to it.
+//  - If valueType is a upper bound, return it if it is at or below alpha, otherwise lower beta to it.
 
 // TTEntry struct is the transposition table entry, defined as below:
 //
@@ -24,7 +25,15 @@
 // depth (max depth - current depth)                                8 bit
 // value                                                            16 bit
 // best move                                                        16 bit
-// is exact (otherwise the turn determines if it lower or upper)    8 or 4 bit (boolean)
+// bound (value type)                                               8 bit
+
+enum Bound : uint8_t
+{
+    BOUND_NONE = 0, // Only the move is meaningful
+    BOUND_UPPER = 1,
+    BOUND_LOWER = 2,
+    BOUND_EXACT = BOUND_UPPER | BOUND_LOWER
+};
 
 struct TTEntry
 {
@@ -32,15 +41,16 @@ struct TTEntry
     Move getMove() const { return Move(move); }
     int16_t getValue() const { return value; }
     uint8_t getDepth() const { return depth; }
-    int16_t getIsExact() const { return isExact; }
+    Bound getBound() const { return bound; }
+    bool getIsExact() const { return bound == BOUND_EXACT; }
     // Implementation of TTEntry::save
-    void save(uint64_t z_k, int16_t v, uint8_t d, Move m, bool type)
+    void save(uint64_t z_k, int16_t v, uint8_t d, Move m, Bound b)
     {
         z_key = z_k;
         value = v;
         depth = d;
         move = m;
-        isExact = type;
+        bound = b;
     }
 
 private:
@@ -50,7 +60,7 @@ private:
     uint8_t depth;
     Move move;
     int16_t value;
-    bool isExact;
+    Bound bound;
 };
 
 
@@ -80,7 +90,7 @@ public:
     }
 
     // Save a new entry to the table
-    void save(uint64_t z_key, int16_t value, uint8_t depth, Move move, bool isExact)
+    void save(uint64_t z_key, int16_t value, uint8_t depth, Move move, Bound bound)
     {
         size_t index = z_key % tableSize;
 
@@ -91,7 +101,7 @@ public:
                 table[index].depth = depth;
                 table[index].value = value;
                 table[index].move = move;
-                table[index].isExact = isExact;
+                table[index].bound = bound;
             }
         // If the position was not stored, we store it regardless the depth
         else if (table[index].z_key == 0)
@@ -100,10 +110,23 @@ public:
             table[index].depth = depth;
             table[index].value = value;
             table[index].move = move;
-            table[index].isExact = isExact;
+            table[index].bound = bound;
         }
     }
 
+    // Permille of entries in use, from the first thousand entries
+    int hashfull() const
+    {
+        size_t sample{std::min<size_t>(tableSize, 1000)};
+        if (sample == 0)
+            return 0;
+        size_t entriesInUse{0};
+        for (size_t i = 0; i < sample; ++i)
+            if (table[i].z_key != 0)
+                ++entriesInUse;
+        return static_cast<int>(entriesInUse * 1000 / sample);
+    }
+
     void printTableMemory() const
     {
         size_t entriesInUse = 0;
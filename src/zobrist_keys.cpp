@@ -1,66 +1,66 @@
 #include "zobrist_keys.h"
+#include "precomputed_moves.h"
+#include <algorithm> // For std::find and std::count_if
 #include <iostream>
-#include <vector>
-#include <unordered_set>
-#include <random>
+#include <utility> // For std::swap
 
 namespace zobrist_keys
 {
-    uint64_t pieceZobristNumbers[2][6][64];
-    uint64_t blackToMoveZobristNumber;
-    uint64_t castlingRightsZobristNumbers[16];
-    uint64_t passantSquaresZobristNumbers[64];
+    static_assert(std::find(randomNumbers.begin(), randomNumbers.end(), 0) == randomNumbers.end(), "Zobrist numbers must not be 0");
 
-    std::vector<uint64_t> generateRandomNumbers(size_t count, uint64_t seed)
+    struct CuckooTables
     {
-        std::unordered_set<uint64_t> randomNumbers;
-        std::mt19937_64 eng(seed);
-        std::uniform_int_distribution<uint64_t> distr(1, UINT64_MAX - 1);
+        std::array<uint64_t, 8192> keys{};
+        std::array<Move, 8192> moves{};
+    };
 
-        while (randomNumbers.size() < count)
-        {
-            randomNumbers.insert(distr(eng));
-        }
-
-        return std::vector<uint64_t>(randomNumbers.begin(), randomNumbers.end());
-    }
-
-    void initializeZobristNumbers()
+    // Each move is stored at one of its two hash indices, moving the entry there to its other index if needed.
+    // The 3668 moves fit without any entry having to be dropped.
+    constexpr CuckooTables generateCuckooTables()
     {
-        const size_t totalNumbers = 801;
-        uint64_t seed = 71272;
-        auto randomNumbers = generateRandomNumbers(totalNumbers, seed);
-
-        for (size_t i = 0; i < 64; ++i)
-        {
-            pieceZobristNumbers[0][0][i] = randomNumbers[i];
-            pieceZobristNumbers[0][1][i] = randomNumbers[64 + i];
-            pieceZobristNumbers[0][2][i] = randomNumbers[128 + i];
-            pieceZobristNumbers[0][3][i] = randomNumbers[192 + i];
-            pieceZobristNumbers[0][4][i] = randomNumbers[256 + i];
-            pieceZobristNumbers[0][5][i] = randomNumbers[320 + i];
-            pieceZobristNumbers[1][0][i] = randomNumbers[384 + i];
-            pieceZobristNumbers[1][1][i] = randomNumbers[448 + i];
-            pieceZobristNumbers[1][2][i] = randomNumbers[512 + i];
-            pieceZobristNumbers[1][3][i] = randomNumbers[576 + i];
-            pieceZobristNumbers[1][4][i] = randomNumbers[640 + i];
-            pieceZobristNumbers[1][5][i] = randomNumbers[704 + i];
-        }
+        CuckooTables tables;
+        for (int color = 0; color < 2; ++color)
+            for (int piece = 1; piece < 6; ++piece)
+                for (int square_1 = 0; square_1 < 64; ++square_1)
+                {
+                    uint64_t attacks{};
+                    if (piece == 1)
+                        attacks = precomputed_moves::knight_moves[square_1];
+                    else if (piece == 2)
+                        attacks = precomputed_moves::bishop_full_rays[square_1];
+                    else if (piece == 3)
+                        attacks = precomputed_moves::rook_full_rays[square_1];
+                    else if (piece == 4)
+                        attacks = precomputed_moves::bishop_full_rays[square_1] | precomputed_moves::rook_full_rays[square_1];
+                    else
+                        attacks = precomputed_moves::king_moves[square_1];
 
-        blackToMoveZobristNumber = randomNumbers[768];
-
-        for (size_t i = 0; i < 16; ++i)
-        {
-            castlingRightsZobristNumbers[i] = randomNumbers[769 + i];
-        }
-
-        for (size_t i = 0; i < 8; ++i)
-        {
-            passantSquaresZobristNumbers[16 + i] = randomNumbers[785 + i];
-            passantSquaresZobristNumbers[40 + i] = randomNumbers[793 + i];
-        }
+                    for (int square_2 = square_1 + 1; square_2 < 64; ++square_2)
+                    {
+                        if ((attacks & (1ULL << square_2)) == 0)
+                            continue;
+                        Move move{Move(square_1, square_2)};
+                        uint64_t key{pieceZobristNumbers[color][piece][square_1] ^ pieceZobristNumbers[color][piece][square_2] ^ blackToMoveZobristNumber};
+                        int index{cuckooHash1(key)};
+                        while (true)
+                        {
+                            std::swap(tables.keys[index], key);
+                            std::swap(tables.moves[index], move);
+                            if (move.getData() == 0) // Arrived at an empty slot
+                                break;
+                            index = (index == cuckooHash1(key)) ? cuckooHash2(key) : cuckooHash1(key);
+                        }
+                    }
+                }
+        return tables;
     }
 
+    constexpr CuckooTables cuckooTables{generateCuckooTables()};
+    constexpr std::array<uint64_t, 8192> cuckooKeys{cuckooTables.keys};
+    constexpr std::array<Move, 8192> cuckooMoves{cuckooTables.moves};
+    static_assert(std::count_if(cuckooTables.moves.begin(), cuckooTables.moves.end(), [](const Move &move) { return move.getData() != 0; }) == 3668,
+                  "Every cuckoo move must have been stored");
+
     void printArray(const uint64_t *arr, size_t size, const std::string &name)
     {
         std::cout << name << ":\n";
@@ -74,7 +74,7 @@ namespace zobrist_keys
     void printAllZobristKeys()
     {
         std::cout << "blackToMoveZobristNumber: " << blackToMoveZobristNumber << "\n";
-        printArray(castlingRightsZobristNumbers, 16, "castlingRightsZobristNumbers");
-        printArray(passantSquaresZobristNumbers, 64, "passantSquaresZobristNumbers");
+        printArray(castlingRightsZobristNumbers.data(), 16, "castlingRightsZobristNumbers");
+        printArray(passantSquaresZobristNumbers.data(), 64, "passantSquaresZobristNumbers");
     }
 }
@@ -1,21 +1,72 @@
 #ifndef ZOBRIST_KEYS_H
 #define ZOBRIST_KEYS_H
 
-#include <vector>
-#include <unordered_set>
-#include <random>
+#include <array>
 #include <iostream>
 #include <cstdint>
+#include "move.h"
+
+// The zobrist numbers are computed at compile time, so that xors of known pieces and squares
+// (like the rook of a castling) are folded by the compiler and nothing is initialized at startup.
 
 namespace zobrist_keys
 {
-    extern uint64_t pieceZobristNumbers[2][6][64];
-    extern uint64_t blackToMoveZobristNumber;
-    extern uint64_t castlingRightsZobristNumbers[16];
-    extern uint64_t passantSquaresZobristNumbers[64];
+    constexpr size_t ZOBRIST_NUMBERS_COUNT{801};
+    constexpr uint64_t ZOBRIST_SEED{71272};
+
+    // splitmix64: its outputs are a bijection of an incrementing counter, so they are all distinct
+    constexpr std::array<uint64_t, ZOBRIST_NUMBERS_COUNT> generateRandomNumbers(uint64_t seed)
+    {
+        std::array<uint64_t, ZOBRIST_NUMBERS_COUNT> randomNumbers{};
+        for (auto &number : randomNumbers)
+        {
+            seed += 0x9E3779B97F4A7C15ULL;
+            uint64_t z{seed};
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            number = z ^ (z >> 31);
+        }
+        return randomNumbers;
+    }
+
+    inline constexpr std::array<uint64_t, ZOBRIST_NUMBERS_COUNT> randomNumbers{generateRandomNumbers(ZOBRIST_SEED)};
+
+    // Indexed by [color][piece][square]
+    inline constexpr auto pieceZobristNumbers = []
+    {
+        std::array<std::array<std::array<uint64_t, 64>, 6>, 2> numbers{};
+        for (size_t color = 0; color < 2; ++color)
+            for (size_t piece = 0; piece < 6; ++piece)
+                for (size_t square = 0; square < 64; ++square)
+                    numbers[color][piece][square] = randomNumbers[(color * 6 + piece) * 64 + square];
+        return numbers;
+    }();
+    inline constexpr uint64_t blackToMoveZobristNumber{randomNumbers[768]};
+    inline constexpr auto castlingRightsZobristNumbers = []
+    {
+        std::array<uint64_t, 16> numbers{};
+        for (size_t i = 0; i < 16; ++i)
+            numbers[i] = randomNumbers[769 + i];
+        return numbers;
+    }();
+    // Only the passant squares of the third and sixth rows are set
+    inline constexpr auto passantSquaresZobristNumbers = []
+    {
+        std::array<uint64_t, 64> numbers{};
+        for (size_t i = 0; i < 8; ++i)
+        {
+            numbers[16 + i] = randomNumbers[785 + i];
+            numbers[40 + i] = randomNumbers[793 + i];
+        }
+        return numbers;
+    }();
 
-    std::vector<uint64_t> generateRandomNumbers(size_t count, uint64_t seed);
-    void initializeZobristNumbers();
+    // Cuckoo tables of the moves of non pawn pieces between two squares, keyed by the zobrist key difference
+    // they make (piece on both squares and side to move). Used to find upcoming repetitions.
+    extern const std::array<uint64_t, 8192> cuckooKeys;
+    extern const std::array<Move, 8192> cuckooMoves;
+    constexpr int cuckooHash1(uint64_t key) { return key & 0x1FFF; }
+    constexpr int cuckooHash2(uint64_t key) { return (key >> 16) & 0x1FFF; }
 
     void printAllZobristKeys();
 }